@@ -0,0 +1,158 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "DomainMask.h"
+
+// Tables d'alias (méthode de Vose) pour le tirage pondéré d'une tuile : construction en O(n),
+// tirage en O(1) avec un seul nombre aléatoire.
+// Les tables sont mises en cache par (catégorie de poids, domaine) : deux cellules de même
+// catégorie et de même domaine ont exactement la même distribution.
+
+struct AliasEntry
+{
+    int offset = 0; // Début des colonnes dans le pool
+    int count = 0;  // Nombre de tuiles du domaine
+};
+
+class AliasCache
+{
+private:
+    struct Key
+    {
+        uint32_t category;
+        DomainMask domain;
+
+        bool operator==(const Key &other) const { return category == other.category && domain == other.domain; }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const
+        {
+            uint64_t h = key.category * 0x9E3779B97F4A7C15ull;
+            for (uint64_t w : key.domain.words)
+            {
+                h ^= w + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+            }
+            return (size_t)(h ^ (h >> 32));
+        }
+    };
+
+    // Colonnes de toutes les tables, mises bout à bout
+    std::vector<int> tiles;
+    std::vector<float> probability;
+    std::vector<int> alias;
+    std::vector<AliasEntry> entries;
+    std::unordered_map<Key, int, KeyHash> lookup;
+
+    // Piles de travail de la construction, conservées pour ne pas réallouer
+    std::vector<int> small, large;
+    std::vector<float> scaled;
+
+    size_t maxColumns = 1 << 20; // Au-delà, le cache est vidé
+
+    int build(const DomainMask &domain, const float *weights)
+    {
+        int n = domain.count();
+        if (tiles.size() + n > maxColumns)
+            clear();
+
+        AliasEntry entry;
+        entry.offset = (int)tiles.size();
+        entry.count = n;
+
+        float total = 0.0f;
+        domain.forEach([&](int tileId)
+        {
+            tiles.push_back(tileId);
+            total += weights[tileId] > 0.0f ? weights[tileId] : 0.0f;
+        });
+
+        // Aucun poids exploitable : distribution uniforme
+        scaled.clear();
+        for (int i = 0; i < n; i++)
+        {
+            float w = weights[tiles[entry.offset + i]];
+            if (total <= 0.0f)
+                scaled.push_back(1.0f);
+            else
+                scaled.push_back(w > 0.0f ? w * n / total : 0.0f);
+        }
+
+        probability.resize(tiles.size());
+        alias.resize(tiles.size());
+        small.clear();
+        large.clear();
+        for (int i = 0; i < n; i++)
+            (scaled[i] < 1.0f ? small : large).push_back(i);
+
+        while (!small.empty() && !large.empty())
+        {
+            int s = small.back();
+            small.pop_back();
+            int l = large.back();
+            probability[entry.offset + s] = scaled[s];
+            alias[entry.offset + s] = tiles[entry.offset + l];
+
+            scaled[l] -= 1.0f - scaled[s];
+            if (scaled[l] < 1.0f)
+            {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        // Restes (arrondis flottants) : colonnes pleines
+        for (int i : large)
+        {
+            probability[entry.offset + i] = 1.0f;
+            alias[entry.offset + i] = tiles[entry.offset + i];
+        }
+        for (int i : small)
+        {
+            probability[entry.offset + i] = 1.0f;
+            alias[entry.offset + i] = tiles[entry.offset + i];
+        }
+
+        entries.push_back(entry);
+        return (int)entries.size() - 1;
+    }
+
+public:
+    void clear()
+    {
+        tiles.clear();
+        probability.clear();
+        alias.clear();
+        entries.clear();
+        lookup.clear();
+    }
+
+    int size() const { return (int)entries.size(); }
+
+    // Table de (category, domain), nullptr si absente du cache
+    const AliasEntry *find(uint32_t category, const DomainMask &domain) const
+    {
+        auto it = lookup.find(Key{category, domain});
+        return (it != lookup.end()) ? &entries[it->second] : nullptr;
+    }
+
+    // Construit et met en cache la table de (category, domain) depuis weights[tileId]
+    const AliasEntry &insert(uint32_t category, const DomainMask &domain, const float *weights)
+    {
+        int id = build(domain, weights);
+        lookup.emplace(Key{category, domain}, id);
+        return entries[id];
+    }
+
+    // Tire une tuile de la table avec u uniforme dans [0, 1[
+    int sample(const AliasEntry &entry, float u) const
+    {
+        float position = u * entry.count;
+        int column = (int)position;
+        if (column >= entry.count)
+            column = entry.count - 1;
+        int i = entry.offset + column;
+        return (position - column < probability[i]) ? tiles[i] : alias[i];
+    }
+};
@@ -0,0 +1,140 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "WFCEngine.h"
+
+// Etat publié par le solveur : tuile fixée de chaque cellule (-1 si non fixée), dans l'ordre
+// de linearIndex, et bilan cumulé de la résolution au moment de la publication
+struct TileSnapshot
+{
+    std::vector<int16_t> tiles;
+    uint64_t sequence = 0; // Numéro de publication, 0 = aucune publication
+    int steps = 0;
+    int collapsedCells = 0;
+    int totalCells = 0;
+    bool finished = false;
+    bool failed = false;
+};
+
+// Résout un WFC sur un thread dédié et publie des instantanés immuables à cadence fixe.
+// Triple tampon : le solveur écrit dans le tampon arrière, puis l'échange avec le tampon
+// du milieu ; le lecteur échange le milieu avec son tampon avant quand une publication est
+// arrivée. Aucun verrou, et ni le solveur ni le lecteur n'attendent l'autre.
+// Un seul lecteur. Pendant que le solveur tourne, l'engine ne doit plus être touché ailleurs.
+template <typename Engine>
+class BackgroundSolver
+{
+private:
+    Engine &engine;
+    std::thread worker;
+    std::atomic<bool> stopRequested{false};
+    std::atomic<bool> running{false};
+    std::atomic<long long> cadenceUs;
+    SelectionOrder order;
+
+    TileSnapshot buffers[3];
+    int backIndex = 0;  // Réservé au solveur
+    int frontIndex = 1; // Réservé au lecteur
+    static constexpr int FRESH = 4; // Bit ajouté à l'indice du milieu quand il n'a pas encore été lu
+    std::atomic<int> middle{2};
+
+    // Etat courant côté solveur, tenu à jour par drainChanges()
+    std::vector<int16_t> current;
+    std::vector<CellChange> changes;
+    TileSnapshot progress;
+
+    void applyChanges()
+    {
+        engine.drainChanges(changes);
+        for (const CellChange &change : changes)
+            current[engine.linearIndex(change.x, change.y, change.z)] = (int16_t)change.tileId;
+    }
+
+    void publish()
+    {
+        applyChanges();
+        TileSnapshot &back = buffers[backIndex];
+        back.tiles = current; // Même taille à chaque fois : simple copie, pas d'allocation
+        back.sequence = ++progress.sequence;
+        back.steps = progress.steps;
+        back.collapsedCells = progress.collapsedCells;
+        back.totalCells = progress.totalCells;
+        back.finished = progress.finished;
+        back.failed = progress.failed;
+        backIndex = middle.exchange(backIndex | FRESH, std::memory_order_acq_rel) & ~FRESH;
+    }
+
+    void run()
+    {
+        while (!stopRequested.load(std::memory_order_relaxed))
+        {
+            RunStats stats = engine.runFor(std::chrono::microseconds(cadenceUs.load(std::memory_order_relaxed)), order);
+            progress.steps += stats.steps;
+            progress.collapsedCells = stats.collapsedCells;
+            progress.totalCells = stats.totalCells;
+            progress.finished = stats.finished;
+            progress.failed = stats.failed;
+            publish();
+            if (stats.finished || stats.failed)
+                break;
+        }
+        running.store(false, std::memory_order_release);
+    }
+
+public:
+    // cadence : durée de résolution entre deux publications
+    explicit BackgroundSolver(Engine &wfc, std::chrono::microseconds publishCadence = std::chrono::milliseconds(16))
+        : engine(wfc), cadenceUs(publishCadence.count()), order(SelectionOrder::MinEntropy)
+    {
+    }
+
+    ~BackgroundSolver() { stop(); }
+
+    BackgroundSolver(const BackgroundSolver &) = delete;
+    BackgroundSolver &operator=(const BackgroundSolver &) = delete;
+
+    // Lance (ou relance) la résolution depuis l'état courant de l'engine
+    void start(SelectionOrder selection = SelectionOrder::MinEntropy)
+    {
+        if (worker.joinable())
+            stop();
+        order = selection;
+        current.assign(engine.getCellCount(), -1);
+        for (int y = 0; y < engine.getHeight(); y++)
+            for (int z = 0; z < engine.getDepth(); z++)
+                for (int x = 0; x < engine.getWidth(); x++)
+                    current[engine.linearIndex(x, y, z)] = (int16_t)engine.getCell(x, y, z).collapsedTile;
+        engine.drainChanges(changes); // Déjà pris en compte ci-dessus
+        uint64_t sequence = progress.sequence; // Les numéros restent croissants d'un lancement à l'autre
+        progress = TileSnapshot();
+        progress.sequence = sequence;
+
+        stopRequested.store(false, std::memory_order_relaxed);
+        running.store(true, std::memory_order_release);
+        worker = std::thread([this] { run(); });
+    }
+
+    // Interrompt le solveur au plus tard à la fin de sa tranche en cours, et attend le thread
+    void stop()
+    {
+        stopRequested.store(true, std::memory_order_relaxed);
+        if (worker.joinable())
+            worker.join();
+    }
+
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+
+    void setCadence(std::chrono::microseconds publishCadence) { cadenceUs.store(publishCadence.count(), std::memory_order_relaxed); }
+
+    // Dernier instantané publié (tiles vide tant que rien n'a été publié). La référence reste
+    // valide et inchangée jusqu'au prochain appel de latest() par le même lecteur.
+    const TileSnapshot &latest()
+    {
+        if (middle.load(std::memory_order_relaxed) & FRESH)
+            frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & ~FRESH;
+        return buffers[frontIndex];
+    }
+};
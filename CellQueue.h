@@ -0,0 +1,65 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+
+// File FIFO circulaire d'indices de cellules, conservée d'une propagation à l'autre.
+// La capacité double quand elle est pleine ; on garde la trace des agrandissements
+// et de la profondeur maximale atteinte.
+class CellQueue
+{
+private:
+    std::vector<int> buffer; // Taille toujours puissance de 2
+    size_t head = 0;
+    size_t count = 0;
+    int growths = 0;
+    int maxDepth = 0;
+
+    void grow()
+    {
+        std::vector<int> larger(std::max<size_t>(64, buffer.size() * 2));
+        for (size_t i = 0; i < count; i++)
+            larger[i] = buffer[(head + i) & (buffer.size() - 1)];
+        buffer.swap(larger);
+        head = 0;
+        growths++;
+    }
+
+public:
+    bool empty() const { return count == 0; }
+    int size() const { return (int)count; }
+    int capacity() const { return (int)buffer.size(); }
+    int getGrowths() const { return growths; }
+    int getMaxDepth() const { return maxDepth; }
+
+    void push(int idx)
+    {
+        if (count == buffer.size())
+            grow();
+        buffer[(head + count) & (buffer.size() - 1)] = idx;
+        count++;
+        maxDepth = std::max(maxDepth, (int)count);
+    }
+
+    int pop()
+    {
+        int idx = buffer[head];
+        head = (head + 1) & (buffer.size() - 1);
+        count--;
+        return idx;
+    }
+
+    void clear()
+    {
+        head = 0;
+        count = 0;
+    }
+
+    // i-ème élément depuis la tête (0 = prochain pop)
+    int at(size_t i) const { return buffer[(head + i) & (buffer.size() - 1)]; }
+
+    void resetStats()
+    {
+        growths = 0;
+        maxDepth = 0;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,273 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include "WFCEngine.h"
+
+// Position d'un chunk dans le monde (en chunks, pas en cellules)
+struct ChunkCoord
+{
+    int x, z;
+};
+
+// Bilan cumulé de ChunkedWorld
+struct ChunkStats
+{
+    int generated = 0;  // Chunks résolus
+    int retries = 0;    // Résolutions reprises avec une autre graine
+    int blockRepairs = 0; // Résolutions élargies aux chunks voisins (modifiés au passage)
+    int failures = 0;   // Chunks impossibles à résoudre
+    int evicted = 0;
+};
+
+// Monde sans bornes en x et z, découpé en chunks de chunkSizeX x height x chunkSizeZ cellules.
+// Chaque nouveau chunk est résolu seul, les faces des chunks voisins déjà présents réduisant le
+// domaine de ses cellules de bord. Si le chunk est insoluble sous ces contraintes, la résolution
+// est reprise sur une boîte élargie qui rouvre une bande des chunks voisins ("modifying in
+// blocks") : ces voisins sont alors modifiés et signalés par drainModified().
+// La mémoire se limite aux chunks présents : evictOutside() libère les chunks éloignés.
+// Chaque chunk a sa propre graine, dérivée de sa position et de la graine du monde ; ses bords
+// dépendent en revanche des voisins déjà présents, donc de l'ordre des demandes.
+template <typename WeightPolicy>
+class ChunkedWorld
+{
+public:
+    using Engine = BasicWFCEngine<SharedWeights<WeightPolicy>>;
+    using DomainFunc = std::function<DomainMask(int x, int y, int z)>;
+
+private:
+    struct Chunk
+    {
+        std::vector<int16_t> tiles; // Ordre x, puis z, puis y (coordonnées locales)
+    };
+
+    int chunkSizeX, height, chunkSizeZ;
+    std::vector<TileRule> tileSet;
+    unsigned int seed;
+    const WeightPolicy &weights;
+    DomainFunc initialDomain; // Vide : toutes les tuiles
+
+    Engine engine; // Moteur d'un chunk, réutilisé d'un chunk à l'autre
+    std::unordered_map<uint64_t, Chunk> chunks;
+    std::vector<ChunkCoord> modified;
+    int repairBand = 4;
+    int maxRetries = 2;
+    ChunkStats stats;
+
+    static uint64_t key(int cx, int cz) { return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cz; }
+
+    // Division arrondie vers -infini (coordonnées négatives)
+    static int floorDiv(int a, int b) { return (a >= 0) ? a / b : -((-a + b - 1) / b); }
+
+    const Chunk *findChunk(int cx, int cz) const
+    {
+        auto it = chunks.find(key(cx, cz));
+        return (it == chunks.end()) ? nullptr : &it->second;
+    }
+
+    int localIndex(int lx, int y, int lz) const { return y * (chunkSizeX * chunkSizeZ) + lz * chunkSizeX + lx; }
+
+    // Tuile d'une cellule du monde qui n'est pas rouverte, -1 si son chunk est absent
+    int committedTile(int x, int y, int z) const
+    {
+        int cx = floorDiv(x, chunkSizeX);
+        int cz = floorDiv(z, chunkSizeZ);
+        const Chunk *chunk = findChunk(cx, cz);
+        return chunk ? chunk->tiles[localIndex(x - cx * chunkSizeX, y, z - cz * chunkSizeZ)] : -1;
+    }
+
+    // Résout la boîte [x0, x1[ x [z0, z1[ (toute la hauteur) : cellules de bord restreintes par
+    // leurs voisins hors de la boîte. Ecrit le résultat dans les chunks présents et dans target.
+    bool solveBox(Engine &boxEngine, int x0, int z0, int x1, int z1, int targetX, int targetZ, unsigned int boxSeed)
+    {
+        const AdjacencyTable &adjacency = boxEngine.getAdjacency();
+        DomainMask allTiles;
+        allTiles.fill((int)tileSet.size());
+
+        const int sideDirs[4] = {0, 1, 4, 5}; // -X, +X, -Z, +Z
+        const int stepX[6] = {-1, 1, 0, 0, 0, 0};
+        const int stepZ[6] = {0, 0, 0, 0, -1, 1};
+
+        std::vector<DomainMask> domains(boxEngine.getCellCount());
+        for (int y = 0; y < height; y++)
+            for (int z = z0; z < z1; z++)
+                for (int x = x0; x < x1; x++)
+                {
+                    DomainMask domain = initialDomain ? (initialDomain(x, y, z) & allTiles) : allTiles;
+                    for (int dir : sideDirs)
+                    {
+                        int nx = x + stepX[dir];
+                        int nz = z + stepZ[dir];
+                        if (nx >= x0 && nx < x1 && nz >= z0 && nz < z1)
+                            continue;
+                        int neighborTile = committedTile(nx, y, nz);
+                        if (neighborTile >= 0)
+                            domain &= adjacency.mask(dir ^ 1, neighborTile); // Tuiles que le voisin accepte de ce côté
+                    }
+                    domains[boxEngine.linearIndex(x - x0, y, z - z0)] = domain;
+                }
+
+        boxEngine.setSeed(boxSeed);
+        boxEngine.setOrigin(x0, 0, z0);
+        boxEngine.reset(domains.data());
+        RunStats run = boxEngine.runUntil([](const RunStats &) { return false; });
+        if (!run.finished)
+            return false;
+
+        // Recopie dans le chunk cible et dans les chunks voisins rouverts
+        for (int z = z0; z < z1; z++)
+            for (int x = x0; x < x1; x++)
+            {
+                int cx = floorDiv(x, chunkSizeX);
+                int cz = floorDiv(z, chunkSizeZ);
+                Chunk *chunk = nullptr;
+                if (cx == targetX && cz == targetZ)
+                {
+                    Chunk &target = chunks[key(cx, cz)];
+                    if (target.tiles.empty())
+                        target.tiles.assign((size_t)chunkSizeX * height * chunkSizeZ, -1);
+                    chunk = &target;
+                }
+                else
+                {
+                    auto it = chunks.find(key(cx, cz));
+                    if (it == chunks.end())
+                        continue; // Chunk absent : cellules résolues pour rien, oubliées
+                    chunk = &it->second;
+                }
+                for (int y = 0; y < height; y++)
+                    chunk->tiles[localIndex(x - cx * chunkSizeX, y, z - cz * chunkSizeZ)] =
+                        (int16_t)boxEngine.getCell(x - x0, y, z - z0).collapsedTile;
+            }
+        return true;
+    }
+
+    unsigned int chunkSeed(int cx, int cz, int attempt) const
+    {
+        return (unsigned int)splitmix64(key(cx, cz) ^ ((uint64_t)seed << 40) ^ ((uint64_t)attempt << 32));
+    }
+
+public:
+    // La politique de poids est partagée par référence : elle doit vivre aussi longtemps que le
+    // monde et accepter toutes les coordonnées du monde (négatives comprises)
+    ChunkedWorld(int sizeX, int h, int sizeZ, const std::vector<TileRule> &rules, unsigned int worldSeed,
+                 const WeightPolicy &policy)
+        : chunkSizeX(sizeX), height(h), chunkSizeZ(sizeZ), tileSet(rules), seed(worldSeed), weights(policy),
+          engine(sizeX, h, sizeZ, rules, worldSeed, SharedWeights<WeightPolicy>(policy))
+    {
+    }
+
+    // Domaine de départ de chaque cellule du monde, avant les contraintes des voisins
+    void setInitialDomains(DomainFunc func) { initialDomain = std::move(func); }
+
+    void setBacktracking(int maxDepth, int maxRetries) { engine.setBacktracking(maxDepth, maxRetries); }
+    void setEntropyMode(EntropyMode mode) { engine.setEntropyMode(mode); }
+
+    // Largeur de la bande rouverte dans les chunks voisins quand un chunk est insoluble
+    void setRepairBand(int band) { repairBand = std::max(1, std::min(band, std::min(chunkSizeX, chunkSizeZ))); }
+
+    // Résout le chunk (cx, cz) s'il n'est pas déjà présent ; false s'il reste insoluble
+    bool generate(int cx, int cz)
+    {
+        if (findChunk(cx, cz))
+            return true;
+
+        int x0 = cx * chunkSizeX, z0 = cz * chunkSizeZ;
+        for (int attempt = 0; attempt <= maxRetries; attempt++)
+        {
+            if (attempt > 0)
+                stats.retries++;
+            if (solveBox(engine, x0, z0, x0 + chunkSizeX, z0 + chunkSizeZ, cx, cz, chunkSeed(cx, cz, attempt)))
+            {
+                stats.generated++;
+                modified.push_back({cx, cz});
+                return true;
+            }
+        }
+
+        // Contraintes des voisins incompatibles : on rouvre une bande de chaque voisin présent
+        for (int band = repairBand; band <= std::max(chunkSizeX, chunkSizeZ); band *= 2)
+        {
+            stats.blockRepairs++;
+            Engine boxEngine(chunkSizeX + 2 * band, height, chunkSizeZ + 2 * band, tileSet, seed,
+                             SharedWeights<WeightPolicy>(weights));
+            boxEngine.setBacktracking(256, 10000);
+            boxEngine.setEntropyMode(engine.getEntropyMode());
+            if (solveBox(boxEngine, x0 - band, z0 - band, x0 + chunkSizeX + band, z0 + chunkSizeZ + band, cx, cz,
+                         chunkSeed(cx, cz, maxRetries + band)))
+            {
+                stats.generated++;
+                for (int dz = -1; dz <= 1; dz++)
+                    for (int dx = -1; dx <= 1; dx++)
+                        if (findChunk(cx + dx, cz + dz))
+                            modified.push_back({cx + dx, cz + dz});
+                return true;
+            }
+        }
+        stats.failures++;
+        return false;
+    }
+
+    // Résout les chunks absents à au plus `radius` chunks de (cx, cz), les plus proches d'abord.
+    // Renvoie le nombre de chunks résolus.
+    int ensureAround(int cx, int cz, int radius)
+    {
+        std::vector<ChunkCoord> missing;
+        for (int dz = -radius; dz <= radius; dz++)
+            for (int dx = -radius; dx <= radius; dx++)
+                if (!findChunk(cx + dx, cz + dz))
+                    missing.push_back({cx + dx, cz + dz});
+        std::sort(missing.begin(), missing.end(), [&](const ChunkCoord &a, const ChunkCoord &b)
+        {
+            int da = (a.x - cx) * (a.x - cx) + (a.z - cz) * (a.z - cz);
+            int db = (b.x - cx) * (b.x - cx) + (b.z - cz) * (b.z - cz);
+            return da < db;
+        });
+
+        int count = 0;
+        for (const ChunkCoord &c : missing)
+            count += generate(c.x, c.z);
+        return count;
+    }
+
+    // Libère les chunks à plus de `radius` chunks (distance de Chebyshev) de (cx, cz)
+    int evictOutside(int cx, int cz, int radius)
+    {
+        int count = 0;
+        for (auto it = chunks.begin(); it != chunks.end();)
+        {
+            int chunkX = (int)(int32_t)(uint32_t)(it->first >> 32);
+            int chunkZ = (int)(int32_t)(uint32_t)it->first;
+            if (std::max(std::abs(chunkX - cx), std::abs(chunkZ - cz)) > radius)
+            {
+                it = chunks.erase(it);
+                count++;
+            }
+            else
+                ++it;
+        }
+        stats.evicted += count;
+        return count;
+    }
+
+    // Chunks créés ou modifiés depuis le dernier appel (un chunk peut apparaître plusieurs fois)
+    void drainModified(std::vector<ChunkCoord> &out)
+    {
+        out.swap(modified);
+        modified.clear();
+    }
+
+    bool hasChunk(int cx, int cz) const { return findChunk(cx, cz) != nullptr; }
+
+    // Tuile d'une cellule du monde, -1 si son chunk n'est pas chargé
+    int getTile(int x, int y, int z) const { return committedTile(x, y, z); }
+
+    ChunkCoord chunkAt(int x, int z) const { return {floorDiv(x, chunkSizeX), floorDiv(z, chunkSizeZ)}; }
+    int getChunkSizeX() const { return chunkSizeX; }
+    int getChunkSizeZ() const { return chunkSizeZ; }
+    int getHeight() const { return height; }
+    int getLoadedChunkCount() const { return (int)chunks.size(); }
+    const ChunkStats &getStats() const { return stats; }
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+
+// Générateur à compteur (mélange splitmix64) : chaque tirage est une fonction pure de
+// (graine, clé de cellule, tentative, flux). Le résultat ne dépend donc pas de l'ordre dans
+// lequel les cellules sont traitées, ce qui permet aux solveurs parallèles ou par morceaux de
+// reproduire exactement le monde du solveur séquentiel.
+
+inline uint64_t splitmix64(uint64_t v)
+{
+    v += 0x9E3779B97F4A7C15ull;
+    v = (v ^ (v >> 30)) * 0xBF58476D1CE4E5B9ull;
+    v = (v ^ (v >> 27)) * 0x94D049BB133111EBull;
+    return v ^ (v >> 31);
+}
+
+// Flux indépendants pour une même cellule
+enum RngStream : uint32_t
+{
+    RNG_TIE_BREAK = 0, // Départage des entropies égales
+    RNG_COLLAPSE = 1   // Choix de la tuile
+};
+
+struct CounterRng
+{
+    uint64_t seed = 0;
+
+    CounterRng() = default;
+    explicit CounterRng(uint64_t s) : seed(splitmix64(s)) {}
+
+    // Clé de cellule à partir de coordonnées globales (21 bits signés par axe)
+    static uint64_t cellKey(int x, int y, int z)
+    {
+        const uint64_t mask = (uint64_t(1) << 21) - 1;
+        return ((uint64_t)x & mask) | (((uint64_t)y & mask) << 21) | (((uint64_t)z & mask) << 42);
+    }
+
+    uint64_t bits(uint64_t cell, uint32_t attempt, uint32_t stream) const
+    {
+        uint64_t h = splitmix64(seed ^ cell);
+        return splitmix64(h ^ (((uint64_t)stream << 32) | attempt));
+    }
+
+    // Flottant uniforme dans [0, 1[ (24 bits de mantisse)
+    float unit(uint64_t cell, uint32_t attempt, uint32_t stream) const
+    {
+        return (float)(bits(cell, attempt, stream) >> 40) * (1.0f / 16777216.0f);
+    }
+};
@@ -0,0 +1,174 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Nombre maximal de tuiles représentables dans un domaine (multiple de 64)
+// Par défaut un seul mot de 64 bits : suffisant pour les petits jeux de tuiles
+// Pour des jeux plus grands, compiler avec -DWFC_MAX_TILES=256 (par exemple)
+#ifndef WFC_MAX_TILES
+#define WFC_MAX_TILES 64
+#endif
+
+static_assert(WFC_MAX_TILES > 0 && WFC_MAX_TILES % 64 == 0, "WFC_MAX_TILES doit etre un multiple de 64");
+
+inline int popcount64(uint64_t v)
+{
+#if defined(_MSC_VER)
+    return (int)__popcnt64(v);
+#else
+    return __builtin_popcountll(v);
+#endif
+}
+
+// Index du bit de poids faible (v ne doit pas être nul)
+inline int lowestBit64(uint64_t v)
+{
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward64(&idx, v);
+    return (int)idx;
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+// Ensemble de tuiles sous forme de bitset dense
+// Words = 1 pour les petits jeux de tuiles, plusieurs mots au-delà de 64 tuiles
+template <int Words>
+struct BasicDomainMask
+{
+    static constexpr int capacity = Words * 64;
+
+    uint64_t words[Words] = {};
+
+    void set(int id) { words[id >> 6] |= uint64_t(1) << (id & 63); }
+    void reset(int id) { words[id >> 6] &= ~(uint64_t(1) << (id & 63)); }
+    bool test(int id) const { return (words[id >> 6] >> (id & 63)) & 1; }
+
+    void clear()
+    {
+        for (int i = 0; i < Words; i++)
+            words[i] = 0;
+    }
+
+    // Active les `count` premières tuiles
+    void fill(int count)
+    {
+        for (int i = 0; i < Words; i++)
+        {
+            int bitsInWord = count - i * 64;
+            if (bitsInWord >= 64)
+                words[i] = ~uint64_t(0);
+            else if (bitsInWord > 0)
+                words[i] = (uint64_t(1) << bitsInWord) - 1;
+            else
+                words[i] = 0;
+        }
+    }
+
+    int count() const
+    {
+        int total = 0;
+        for (int i = 0; i < Words; i++)
+            total += popcount64(words[i]);
+        return total;
+    }
+
+    bool empty() const
+    {
+        for (int i = 0; i < Words; i++)
+            if (words[i])
+                return false;
+        return true;
+    }
+
+    // Première tuile du domaine, -1 si vide
+    int first() const
+    {
+        for (int i = 0; i < Words; i++)
+            if (words[i])
+                return i * 64 + lowestBit64(words[i]);
+        return -1;
+    }
+
+    // Appelle f(tileId) pour chaque tuile présente, dans l'ordre croissant
+    template <typename F>
+    void forEach(F &&f) const
+    {
+        for (int i = 0; i < Words; i++)
+        {
+            uint64_t w = words[i];
+            while (w)
+            {
+                f(i * 64 + lowestBit64(w));
+                w &= w - 1;
+            }
+        }
+    }
+
+    // Tuiles présentes ici mais pas dans `other`
+    BasicDomainMask without(const BasicDomainMask &other) const
+    {
+        BasicDomainMask r;
+        for (int i = 0; i < Words; i++)
+            r.words[i] = words[i] & ~other.words[i];
+        return r;
+    }
+
+    BasicDomainMask &operator&=(const BasicDomainMask &other)
+    {
+        for (int i = 0; i < Words; i++)
+            words[i] &= other.words[i];
+        return *this;
+    }
+
+    BasicDomainMask &operator|=(const BasicDomainMask &other)
+    {
+        for (int i = 0; i < Words; i++)
+            words[i] |= other.words[i];
+        return *this;
+    }
+
+    friend BasicDomainMask operator&(BasicDomainMask a, const BasicDomainMask &b) { return a &= b; }
+    friend BasicDomainMask operator|(BasicDomainMask a, const BasicDomainMask &b) { return a |= b; }
+
+    friend bool operator==(const BasicDomainMask &a, const BasicDomainMask &b)
+    {
+        for (int i = 0; i < Words; i++)
+            if (a.words[i] != b.words[i])
+                return false;
+        return true;
+    }
+    friend bool operator!=(const BasicDomainMask &a, const BasicDomainMask &b) { return !(a == b); }
+};
+
+using DomainMask = BasicDomainMask<WFC_MAX_TILES / 64>;
+
+// Allocateur aligné (ex. sur une ligne de cache) pour les tables de masques
+template <typename T, size_t Alignment>
+struct AlignedAllocator
+{
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+    T *allocate(size_t n) { return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(Alignment))); }
+    void deallocate(T *p, size_t) { ::operator delete(p, std::align_val_t(Alignment)); }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment> &) const { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment> &) const { return false; }
+};
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Format binaire des points de sauvegarde de BasicWFCEngine (saveState / loadState).
+// En-tête fixe puis tableaux bruts, chacun aligné sur 8 octets, dans l'ordre de stockage
+// du moteur (disposition mémoire comprise) et l'ordre des octets de la machine :
+//   domains[gridSize]        DomainMask   domaines courants
+//   initialDomains[gridSize] DomainMask   domaines de départ (réparation locale)
+//   attempts[gridSize]       uint32_t     tirages déjà faits par cellule
+//   collapsed[gridSize]      int16_t      tuile fixée, -1 sinon
+//   pendingCells[pendingCount]    int32_t     file de propagation, dans l'ordre
+//   pendingRemoved[pendingCount]  DomainMask  tuiles retirées pas encore propagées (AC-4)
+// Le fichier peut être projeté en mémoire et relu directement depuis le pointeur.
+// Ni la politique de poids ni l'historique du retour arrière ne sont sauvegardés.
+
+constexpr uint32_t WFC_STATE_VERSION = 1;
+
+struct WFCStateHeader
+{
+    char magic[4]; // "WFCS"
+    uint32_t version;
+    int32_t width, height, depth;
+    int32_t tileCount, maskWords, layout, gridSize;
+    int32_t propagationMode, entropyMode, scanOrder, scanCursor;
+    int32_t originX, originY, originZ;
+    int32_t conflictIdx, collapsedCount, backtrackCount, repairCount, pendingCount; // collapsedCount : recompté au chargement
+    uint8_t failed, entropyTracked, padding[2];
+    uint64_t rulesHash; // Empreinte des règles compilées : refuse un état d'un autre jeu de tuiles
+    uint64_t seed;      // Graine mélangée de CounterRng
+    int64_t waveCount, processedCount;
+};
+
+inline size_t stateAlign(size_t bytes) { return (bytes + 7) & ~(size_t)7; }
+
+// Ecriture séquentielle des sections, chacune complétée à 8 octets
+struct StateWriter
+{
+    std::vector<uint8_t> bytes;
+
+    void write(const void *data, size_t size)
+    {
+        size_t start = bytes.size();
+        bytes.resize(start + stateAlign(size), 0);
+        if (size > 0)
+            std::memcpy(&bytes[start], data, size);
+    }
+};
+
+// Lecture des sections depuis un tampon (éventuellement projeté en mémoire)
+struct StateReader
+{
+    const uint8_t *data;
+    size_t size;
+    size_t offset = 0;
+
+    // Pointeur sur la section suivante, nullptr si le tampon est trop court
+    const uint8_t *next(size_t bytes)
+    {
+        if (offset > size || bytes > size - offset)
+            return nullptr;
+        const uint8_t *section = data + offset;
+        offset += stateAlign(bytes);
+        return section;
+    }
+};
+
+// Fichier en lecture seule, projeté en mémoire quand le système le permet (sinon lu en entier)
+class MappedFile
+{
+private:
+    const uint8_t *mapped = nullptr;
+    size_t length = 0;
+    std::vector<uint8_t> fallback;
+
+public:
+    explicit MappedFile(const std::string &path)
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd >= 0)
+        {
+            struct stat info;
+            if (::fstat(fd, &info) == 0 && info.st_size > 0)
+            {
+                void *p = ::mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED)
+                {
+                    mapped = (const uint8_t *)p;
+                    length = (size_t)info.st_size;
+                }
+            }
+            ::close(fd);
+            if (mapped)
+                return;
+        }
+#endif
+        std::ifstream file(path, std::ios::binary);
+        if (file)
+            fallback.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    ~MappedFile()
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        if (mapped)
+            ::munmap((void *)mapped, length);
+#endif
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const uint8_t *data() const { return mapped ? mapped : fallback.data(); }
+    size_t size() const { return mapped ? length : fallback.size(); }
+};
@@ -0,0 +1,148 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include <queue>
+#include <functional>
+
+// Tas binaire min indexé par cellule : top() en O(1), mise à jour de clé en O(log n)
+class EntropyHeap
+{
+private:
+    std::vector<int> heap;     // Indices de cellules, ordonnés par clé
+    std::vector<int> position; // Position de chaque cellule dans heap (-1 si absente)
+    std::vector<float> keys;
+
+    bool less(int a, int b) const { return keys[heap[a]] < keys[heap[b]]; }
+
+    void swapNodes(int a, int b)
+    {
+        std::swap(heap[a], heap[b]);
+        position[heap[a]] = a;
+        position[heap[b]] = b;
+    }
+
+    void siftUp(int i)
+    {
+        while (i > 0)
+        {
+            int parent = (i - 1) / 2;
+            if (!less(i, parent))
+                break;
+            swapNodes(i, parent);
+            i = parent;
+        }
+    }
+
+    void siftDown(int i)
+    {
+        int n = (int)heap.size();
+        while (true)
+        {
+            int smallest = i;
+            int left = 2 * i + 1;
+            int right = left + 1;
+            if (left < n && less(left, smallest))
+                smallest = left;
+            if (right < n && less(right, smallest))
+                smallest = right;
+            if (smallest == i)
+                break;
+            swapNodes(i, smallest);
+            i = smallest;
+        }
+    }
+
+public:
+    // Prépare le tas pour n cellules, toutes absentes
+    void resize(int n)
+    {
+        heap.clear();
+        heap.reserve(n);
+        position.assign(n, -1);
+        keys.assign(n, 0.0f);
+    }
+
+    void clear()
+    {
+        for (int idx : heap)
+            position[idx] = -1;
+        heap.clear();
+    }
+
+    bool empty() const { return heap.empty(); }
+    int size() const { return (int)heap.size(); }
+    bool contains(int idx) const { return position[idx] != -1; }
+    int top() const { return heap.front(); }
+    float key(int idx) const { return keys[idx]; }
+
+    void push(int idx, float key)
+    {
+        keys[idx] = key;
+        position[idx] = (int)heap.size();
+        heap.push_back(idx);
+        siftUp(position[idx]);
+    }
+
+    // Ajout sans réordonnancement, à suivre d'un appel à rebuild()
+    void pushUnordered(int idx, float key)
+    {
+        keys[idx] = key;
+        position[idx] = (int)heap.size();
+        heap.push_back(idx);
+    }
+
+    // Parcourt les cellules par clé croissante sans modifier le tas, au plus maxVisited,
+    // tant que visit(idx) renvoie true. Coût O(k log k) pour k cellules visitées.
+    template <typename Visitor>
+    void visitInOrder(int maxVisited, Visitor &&visit) const
+    {
+        using Node = std::pair<float, int>; // (clé, position dans heap)
+        std::priority_queue<Node, std::vector<Node>, std::greater<Node>> frontier;
+        if (!heap.empty())
+            frontier.push({keys[heap[0]], 0});
+        for (int visited = 0; visited < maxVisited && !frontier.empty(); visited++)
+        {
+            int i = frontier.top().second;
+            frontier.pop();
+            if (!visit(heap[i]))
+                return;
+            for (int child = 2 * i + 1; child <= 2 * i + 2 && child < (int)heap.size(); child++)
+                frontier.push({keys[heap[child]], child});
+        }
+    }
+
+    // Réordonne tout le tas en O(n)
+    void rebuild()
+    {
+        for (int i = (int)heap.size() / 2 - 1; i >= 0; i--)
+            siftDown(i);
+    }
+
+    void update(int idx, float key)
+    {
+        float old = keys[idx];
+        keys[idx] = key;
+        if (key < old)
+            siftUp(position[idx]);
+        else
+            siftDown(position[idx]);
+    }
+
+    void remove(int idx)
+    {
+        int i = position[idx];
+        if (i == -1)
+            return;
+        int last = (int)heap.size() - 1;
+        if (i != last)
+            swapNodes(i, last);
+        heap.pop_back();
+        position[idx] = -1;
+        if (i < (int)heap.size())
+        {
+            int moved = heap[i];
+            siftUp(i);
+            siftDown(position[moved]);
+        }
+    }
+};
\ No newline at end of file
@@ -0,0 +1,257 @@
+#pragma once
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+#include "WFCEngine.h"
+#include "ThreadPool.h"
+
+// Bilan de PartitionedSolver::solve()
+struct PartitionStats
+{
+    int blocks = 0;
+    int seams = 0;
+    int blockRetries = 0; // Blocs résolus à nouveau avec une autre graine
+    int seamRetries = 0;  // Coutures résolues à nouveau sur une bande élargie
+    int failedRegions = 0;
+    std::chrono::microseconds interiorTime{0};
+    std::chrono::microseconds seamTime{0};
+};
+
+// Résolution d'un grand monde par régions : la grille est découpée en blocs (x, z) de toute
+// la hauteur, chaque bloc est résolu par son propre moteur sur un thread du pool, puis les
+// coutures entre blocs sont réparées. Une couture rouvre une bande de seamBand cellules de
+// chaque côté de la frontière et la résout à nouveau, bordée par les cellules déjà résolues
+// (domaines réduits à leur tuile). Les coutures en x (bandes sur toute la profondeur) passent
+// d'abord, puis les coutures en z (sur toute la largeur) : les bandes d'une même passe sont
+// disjointes et résolues en parallèle.
+// Chaque moteur est placé à l'origine de sa région et démarre avec la graine du monde : une cellule
+// tire les mêmes nombres qu'avec un seul moteur, mais le résultat diffère quand même (autre ordre de
+// résolution, bords de région). Seules les reprises après échec changent de graine.
+template <typename WeightPolicy>
+class PartitionedSolver
+{
+public:
+    using Engine = BasicWFCEngine<SharedWeights<WeightPolicy>>;
+
+private:
+    int width, height, depth;
+    std::vector<TileRule> tileSet;
+    unsigned int seed;
+    const WeightPolicy &weights;
+
+    int blockSizeX = 64, blockSizeZ = 64;
+    int seamBand = 4;
+    int maxRetries = 3;
+    int backtrackDepth = 64, backtrackRetries = 1000;
+    EntropyMode entropyMode = EntropyMode::TileCount;
+    SelectionOrder selectionOrder = SelectionOrder::MinEntropy;
+
+    std::vector<int16_t> tiles; // Tuile de chaque cellule du monde (ordre de linearIndex), -1 si non résolue
+    PartitionStats stats;
+
+    // Boîte [x0, x1[ x [0, height[ x [z0, z1[ ; les cellules hors de [openX0, openX1[ x [openZ0, openZ1[
+    // sont figées sur leur tuile actuelle. looseZSeams : le cadre n'est pas figé dans les bandes
+    // des coutures en z, encore incohérentes (elles seront résolues à la passe suivante).
+    struct Region
+    {
+        int x0, x1, z0, z1;
+        int openX0, openX1, openZ0, openZ1;
+        bool looseZSeams = false;
+    };
+
+    bool inZSeamBand(int z) const
+    {
+        int offset = z % blockSizeZ;
+        return (offset < seamBand && z >= blockSizeZ) || (offset >= blockSizeZ - seamBand && z - offset + blockSizeZ < depth);
+    }
+
+    // Résout une région et recopie ses cellules ouvertes ; false si le moteur échoue
+    bool solveRegion(const Region &region, const DomainMask *perCell, unsigned int regionSeed)
+    {
+        int sizeX = region.x1 - region.x0;
+        int sizeZ = region.z1 - region.z0;
+        Engine engine(sizeX, height, sizeZ, tileSet, regionSeed, SharedWeights<WeightPolicy>(weights));
+        if (engine.isFailed())
+            return false;
+
+        DomainMask allTiles;
+        allTiles.fill((int)tileSet.size());
+        std::vector<DomainMask> domains(engine.getCellCount());
+        for (int y = 0; y < height; y++)
+            for (int z = region.z0; z < region.z1; z++)
+                for (int x = region.x0; x < region.x1; x++)
+                {
+                    DomainMask &domain = domains[engine.linearIndex(x - region.x0, y, z - region.z0)];
+                    bool open = x >= region.openX0 && x < region.openX1 && z >= region.openZ0 && z < region.openZ1;
+                    bool loose = region.looseZSeams && inZSeamBand(z);
+                    int fixed = (open || loose) ? -1 : tiles[linearIndex(x, y, z)];
+                    if (fixed >= 0)
+                        domain.set(fixed);
+                    else // Cellule ouverte, ou cadre dans une région restée en échec
+                        domain = perCell ? perCell[linearIndex(x, y, z)] : allTiles;
+                }
+
+        engine.setOrigin(region.x0, 0, region.z0);
+        engine.setEntropyMode(entropyMode);
+        engine.setBacktracking(backtrackDepth, backtrackRetries);
+        engine.reset(domains.data());
+        RunStats run = engine.runUntil([](const RunStats &) { return false; }, selectionOrder);
+        if (!run.finished)
+            return false;
+
+        for (int y = 0; y < height; y++)
+            for (int z = region.openZ0; z < region.openZ1; z++)
+                for (int x = region.openX0; x < region.openX1; x++)
+                    tiles[linearIndex(x, y, z)] = (int16_t)engine.getCell(x - region.x0, y, z - region.z0).collapsedTile;
+        return true;
+    }
+
+    // Bande de la couture à la position `boundary` sur l'axe x (alongX) ou z, avec son cadre figé
+    Region seamRegion(bool alongX, int boundary, int band) const
+    {
+        Region r;
+        if (alongX)
+        {
+            r.openX0 = std::max(0, boundary - band);
+            r.openX1 = std::min(width, boundary + band);
+            r.x0 = std::max(0, r.openX0 - 1);
+            r.x1 = std::min(width, r.openX1 + 1);
+            r.z0 = r.openZ0 = 0;
+            r.z1 = r.openZ1 = depth;
+            r.looseZSeams = true;
+        }
+        else
+        {
+            r.openZ0 = std::max(0, boundary - band);
+            r.openZ1 = std::min(depth, boundary + band);
+            r.z0 = std::max(0, r.openZ0 - 1);
+            r.z1 = std::min(depth, r.openZ1 + 1);
+            r.x0 = r.openX0 = 0;
+            r.x1 = r.openX1 = width;
+        }
+        return r;
+    }
+
+    // Premier essai : graine du monde (mêmes tirages qu'un moteur unique, cellule par cellule) ;
+    // les reprises changent de graine pour sortir de l'échec
+    unsigned int regionSeed(int regionId, int attempt) const
+    {
+        if (attempt == 0)
+            return seed;
+        return (unsigned int)splitmix64(((uint64_t)seed << 32) ^ ((uint64_t)regionId << 8) ^ (uint64_t)attempt);
+    }
+
+    // Toutes les coutures d'un axe en parallèle, puis les échecs en série sur une bande élargie
+    // (les bandes élargies peuvent déborder sur leurs voisines, d'où la passe série)
+    void repairSeams(ThreadPool &pool, bool alongX, const DomainMask *perCell)
+    {
+        int blockSize = alongX ? blockSizeX : blockSizeZ;
+        int extent = alongX ? width : depth;
+        std::vector<int> boundaries;
+        for (int b = blockSize; b < extent; b += blockSize)
+            boundaries.push_back(b);
+        stats.seams += (int)boundaries.size();
+
+        int idBase = alongX ? 1 << 20 : 2 << 20;
+        std::vector<char> solved(boundaries.size(), 0);
+        pool.parallelFor((int)boundaries.size(), [&](int i)
+        {
+            solved[i] = solveRegion(seamRegion(alongX, boundaries[i], seamBand), perCell, regionSeed(idBase + i, 0));
+        });
+
+        for (size_t i = 0; i < boundaries.size(); i++)
+        {
+            int band = seamBand;
+            for (int attempt = 1; !solved[i] && attempt <= maxRetries; attempt++)
+            {
+                band *= 2;
+                stats.seamRetries++;
+                solved[i] = solveRegion(seamRegion(alongX, boundaries[i], band), perCell, regionSeed(idBase + (int)i, attempt));
+            }
+            if (!solved[i])
+                stats.failedRegions++;
+        }
+    }
+
+public:
+    // La politique de poids est partagée par référence entre les moteurs : elle doit rester en
+    // vie pendant solve() et être indexée en coordonnées du monde
+    PartitionedSolver(int w, int h, int d, const std::vector<TileRule> &rules, unsigned int worldSeed,
+                      const WeightPolicy &policy)
+        : width(w), height(h), depth(d), tileSet(rules), seed(worldSeed), weights(policy)
+    {
+    }
+
+    // Taille des blocs en x et z, et demi-largeur des bandes de couture (moins de la moitié d'un
+    // bloc : le cadre d'une couture ne doit pas tomber dans la bande ouverte de sa voisine, résolue
+    // en même temps)
+    void setPartition(int sizeX, int sizeZ, int band)
+    {
+        blockSizeX = std::max(sizeX, 4);
+        blockSizeZ = std::max(sizeZ, 4);
+        seamBand = std::max(1, std::min(band, std::min(blockSizeX, blockSizeZ) / 2 - 1));
+    }
+
+    void setBacktracking(int maxDepth, int maxRetriesPerRegion)
+    {
+        backtrackDepth = maxDepth;
+        backtrackRetries = maxRetriesPerRegion;
+    }
+
+    void setEntropyMode(EntropyMode mode) { entropyMode = mode; }
+    void setSelectionOrder(SelectionOrder order) { selectionOrder = order; }
+    void setMaxRetries(int retries) { maxRetries = std::max(retries, 0); }
+
+    // perCell : domaines de départ du monde entier (ordre de linearIndex), nullptr = toutes les tuiles.
+    // Renvoie true si toutes les régions ont été résolues.
+    bool solve(ThreadPool &pool, const DomainMask *perCell = nullptr)
+    {
+        stats = PartitionStats();
+        tiles.assign((size_t)width * height * depth, -1);
+
+        // 1. Intérieurs : un moteur par bloc, blocs indépendants
+        auto start = std::chrono::steady_clock::now();
+        int blocksX = (width + blockSizeX - 1) / blockSizeX;
+        int blocksZ = (depth + blockSizeZ - 1) / blockSizeZ;
+        stats.blocks = blocksX * blocksZ;
+        std::atomic<int> retries{0};
+        std::atomic<int> failures{0};
+        pool.parallelFor(stats.blocks, [&](int b)
+        {
+            Region r;
+            r.x0 = r.openX0 = (b % blocksX) * blockSizeX;
+            r.z0 = r.openZ0 = (b / blocksX) * blockSizeZ;
+            r.x1 = r.openX1 = std::min(width, r.x0 + blockSizeX);
+            r.z1 = r.openZ1 = std::min(depth, r.z0 + blockSizeZ);
+            bool ok = solveRegion(r, perCell, regionSeed(b, 0));
+            for (int attempt = 1; !ok && attempt <= maxRetries; attempt++)
+            {
+                retries++;
+                ok = solveRegion(r, perCell, regionSeed(b, attempt));
+            }
+            if (!ok)
+                failures++;
+        });
+        stats.blockRetries = retries;
+        stats.failedRegions = failures;
+        auto seamStart = std::chrono::steady_clock::now();
+        stats.interiorTime = std::chrono::duration_cast<std::chrono::microseconds>(seamStart - start);
+
+        // 2. Coutures
+        repairSeams(pool, true, perCell);
+        repairSeams(pool, false, perCell);
+        stats.seamTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - seamStart);
+
+        return stats.failedRegions == 0;
+    }
+
+    // Ordre des tableaux par cellule du monde : x, puis z, puis y
+    int linearIndex(int x, int y, int z) const { return y * (width * depth) + z * width + x; }
+    int getTile(int x, int y, int z) const { return tiles[linearIndex(x, y, z)]; }
+    const std::vector<int16_t> &getTiles() const { return tiles; }
+    const PartitionStats &getStats() const { return stats; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getDepth() const { return depth; }
+};
@@ -0,0 +1,114 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+
+// Groupe de threads fixes pour les boucles parallèles courtes et répétées : les threads
+// attendent entre deux appels au lieu d'être recréés. Le thread appelant participe au travail.
+class ThreadPool
+{
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    const std::function<void(int)> *task = nullptr;
+    int taskCount = 0;
+    std::atomic<int> nextItem{0};
+    int pendingWorkers = 0; // Threads qui n'ont pas encore fini l'appel en cours
+    uint64_t generation = 0; // Incrémenté à chaque parallelFor()
+    bool shuttingDown = false;
+
+    // Prend des éléments jusqu'à épuisement
+    void drain(const std::function<void(int)> &fn, int count)
+    {
+        for (int i = nextItem.fetch_add(1); i < count; i = nextItem.fetch_add(1))
+            fn(i);
+    }
+
+    void workerLoop()
+    {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            wake.wait(lock, [&] { return shuttingDown || generation != seen; });
+            if (shuttingDown)
+                return;
+            seen = generation;
+            const std::function<void(int)> *fn = task;
+            int count = taskCount;
+            lock.unlock();
+
+            drain(*fn, count);
+
+            lock.lock();
+            if (--pendingWorkers == 0)
+                done.notify_all();
+        }
+    }
+
+public:
+    // threadCount : nombre total de threads de calcul, appelant compris (0 = nombre de cœurs)
+    explicit ThreadPool(int threadCount = 0)
+    {
+        if (threadCount <= 0)
+            threadCount = (int)std::max(1u, std::thread::hardware_concurrency());
+        for (int i = 1; i < threadCount; i++)
+            threads.emplace_back([this] { workerLoop(); });
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            shuttingDown = true;
+        }
+        wake.notify_all();
+        for (std::thread &t : threads)
+            t.join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int size() const { return (int)threads.size() + 1; }
+
+    // Appelle fn(i) pour i dans [0, count[, réparti sur tous les threads ; rend la main
+    // quand tous les appels sont terminés
+    void parallelFor(int count, const std::function<void(int)> &fn)
+    {
+        if (count <= 0)
+            return;
+        if (threads.empty() || count == 1)
+        {
+            for (int i = 0; i < count; i++)
+                fn(i);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = &fn;
+            taskCount = count;
+            nextItem.store(0);
+            pendingWorkers = (int)threads.size();
+            generation++;
+        }
+        wake.notify_all();
+
+        drain(fn, count);
+
+        // Chaque thread passe par chaque appel (les retardataires trouvent nextItem épuisé) :
+        // fn reste donc valide tant qu'un thread peut encore la lire
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return pendingWorkers == 0; });
+        task = nullptr;
+    }
+};
@@ -1,11 +1,23 @@
 #pragma once
 #include <vector>
-#include <set>
-#include <random>
+#include <string>
+#include <functional>
 #include <optional>
 #include <tuple>
+#include <algorithm>
+#include <deque>
+#include <cmath>
 #include <climits>
+#include <chrono>
 #include <iostream>
+#include "DomainMask.h"
+#include "EntropyHeap.h"
+#include "CellQueue.h"
+#include "WeightPolicies.h"
+#include "AliasTable.h"
+#include "CounterRng.h"
+#include "ThreadPool.h"
+#include "EngineState.h"
 
 struct TileRule
 {
@@ -17,124 +29,1263 @@ struct TileRule
 
 struct Cell
 {
-    std::set<int> possibleTiles;
+    DomainMask possibleTiles;
     int collapsedTile = -1;
     bool isCollapsed() const { return collapsedTile != -1; }
-    int entropy() const { return (int)possibleTiles.size(); }
+    int entropy() const { return possibleTiles.count(); }
 };
 
-using WeightFunc = std::function<float(int tileId, int x, int y, int z)>;
+// Règles d'adjacence compilées : mask(dir, tuile) = tuiles autorisées chez le voisin dans la direction dir
+// Stockage plat [dir * nbTuiles + tuile], aligné sur une ligne de cache
+struct AdjacencyTable
+{
+    int tileCount = 0;
+    std::vector<DomainMask, AlignedAllocator<DomainMask, 64>> masks;
+
+    const DomainMask &mask(int dir, int tileId) const { return masks[dir * tileCount + tileId]; }
+
+    // Union des masques de toutes les tuiles d'un domaine
+    DomainMask allowed(int dir, const DomainMask &domain) const
+    {
+        DomainMask result;
+        domain.forEach([&](int tileId) { result |= mask(dir, tileId); });
+        return result;
+    }
+};
+
+// Stratégie de propagation des contraintes
+enum class PropagationMode
+{
+    Bitmask,     // OU des masques du domaine source puis ET dans le voisin (petits jeux de tuiles)
+    SupportCount // Compteurs de supports AC-4 (grands jeux de tuiles)
+};
+
+// Statistiques de la file de propagation
+struct PropagationStats
+{
+    long long waves = 0;          // Appels à propagate() ayant traité au moins une cellule
+    long long cellsProcessed = 0; // Cellules sorties de la file
+    int maxQueueDepth = 0;        // Profondeur maximale atteinte par la file
+    int queueCapacity = 0;        // Capacité actuelle de la file
+    int queueGrowths = 0;         // Nombre d'agrandissements de la file
+};
+
+// Critère de sélection de la prochaine cellule à fixer
+enum class EntropyMode
+{
+    TileCount, // Nombre de tuiles encore possibles
+    Shannon    // Entropie de Shannon pondérée par baseWeight et la politique de poids
+};
+
+// Bilan d'un appel à runFor() / runUntil()
+struct RunStats
+{
+    int steps = 0;          // Appels à step() effectués
+    int collapsedCells = 0; // Cellules fixées à la fin de l'appel
+    int totalCells = 0;
+    bool finished = false;  // Plus aucune cellule à fixer
+    bool failed = false;    // Contradiction sans retour arrière possible
+    std::chrono::microseconds elapsed{0};
+};
 
-class WFCEngine
+// Cellule dont l'état fixé a changé depuis le dernier drainChanges()
+struct CellChange
+{
+    int x, y, z;
+    int tileId; // Tuile fixée au moment du drain, -1 si la cellule n'est plus fixée
+};
+
+// Disposition des cellules en mémoire, derrière la même interface getCell(x, y, z)
+enum class GridLayout
+{
+    Linear, // Couches y successives, puis z, puis x
+    Brick4, // Briques de 4x4x4 cellules contiguës
+    Brick8, // Briques de 8x8x8 cellules contiguës
+    Morton  // Courbe en Z (bits de x, y, z entrelacés)
+};
+
+// Ordre de choix de la prochaine cellule à fixer, au choix à chaque appel de step()
+enum class SelectionOrder
+{
+    MinEntropy, // Cellule d'entropie minimale (tas)
+    Layers,     // Balayage couche par couche, du haut vers le bas, dans l'ordre mémoire
+    Columns     // Balayage colonne par colonne, chaque colonne du haut vers le bas
+};
+
+// WeightPolicy : voir WeightPolicies.h
+template <typename WeightPolicy>
+class BasicWFCEngine
 {
 private:
     int width, height, depth;
     std::vector<Cell> grid;
     std::vector<TileRule> tileSet;
-    std::mt19937 rng;
+    CounterRng rng;                // Tirages keyés par (graine, cellule, tentative), voir CounterRng.h
+    std::vector<uint32_t> attempts; // Nombre de tirages de tuile déjà faits par cellule
     bool failed = false;
+    bool configError = false; // Jeu de tuiles trop grand pour DomainMask
+
+    // Indice de stockage : somme de trois décalages par axe, quelle que soit la disposition.
+    // Hors Linear, la grille est complétée jusqu'à des briques (ou puissances de 2) entières ;
+    // les cases de remplissage ne figurent pas dans storedCells et ne sont jamais traitées.
+    GridLayout layout = GridLayout::Linear;
+    std::vector<int> xOffset, yOffset, zOffset;
+    std::vector<int> storedCells; // Indices de stockage des vraies cellules, ordre croissant
+
+    struct StoredCoord
+    {
+        uint16_t x, y, z;
+    };
+    std::vector<StoredCoord> storedCoords; // Coordonnées de chaque indice de stockage (hors Linear)
+
+    int getIndex(int x, int y, int z) const
+    {
+        return xOffset[x] + yOffset[y] + zOffset[z];
+    }
+
+    // Prépare les décalages par axe et renvoie la taille de stockage
+    int buildLayout()
+    {
+        xOffset.resize(width);
+        yOffset.resize(height);
+        zOffset.resize(depth);
+
+        int storageSize = width * height * depth;
+        if (layout == GridLayout::Linear)
+        {
+            for (int x = 0; x < width; x++)
+                xOffset[x] = x;
+            for (int z = 0; z < depth; z++)
+                zOffset[z] = z * width;
+            for (int y = 0; y < height; y++)
+                yOffset[y] = y * (width * depth);
+        }
+        else if (layout == GridLayout::Brick4 || layout == GridLayout::Brick8)
+        {
+            int b = (layout == GridLayout::Brick4) ? 4 : 8;
+            int brickVolume = b * b * b;
+            int bricksX = (width + b - 1) / b;
+            int bricksY = (height + b - 1) / b;
+            int bricksZ = (depth + b - 1) / b;
+            for (int x = 0; x < width; x++)
+                xOffset[x] = (x / b) * brickVolume + x % b;
+            for (int z = 0; z < depth; z++)
+                zOffset[z] = (z / b) * bricksX * brickVolume + (z % b) * b;
+            for (int y = 0; y < height; y++)
+                yOffset[y] = (y / b) * bricksX * bricksZ * brickVolume + (y % b) * b * b;
+            storageSize = bricksX * bricksY * bricksZ * brickVolume;
+        }
+        else
+        {
+            // Bits entrelacés x, y, z tant que chaque axe en a encore : pas de remplissage
+            // au-delà de la puissance de 2 supérieure de chaque dimension
+            int bits[3] = {0, 0, 0};
+            int sizes[3] = {width, height, depth};
+            for (int axis = 0; axis < 3; axis++)
+                while ((1 << bits[axis]) < sizes[axis])
+                    bits[axis]++;
+
+            std::vector<int> *offsets[3] = {&xOffset, &yOffset, &zOffset};
+            for (int axis = 0; axis < 3; axis++)
+                std::fill(offsets[axis]->begin(), offsets[axis]->end(), 0);
+
+            int outBit = 0;
+            for (int bit = 0; bit < std::max({bits[0], bits[1], bits[2]}); bit++)
+            {
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    if (bit >= bits[axis])
+                        continue;
+                    for (int v = 0; v < sizes[axis]; v++)
+                        if ((v >> bit) & 1)
+                            (*offsets[axis])[v] |= 1 << outBit;
+                    outBit++;
+                }
+            }
+            storageSize = 1 << outBit;
+        }
+
+        storedCells.clear();
+        storedCoords.clear();
+        if (layout != GridLayout::Linear)
+            storedCoords.assign(storageSize, StoredCoord{0xFFFF, 0xFFFF, 0xFFFF});
+        for (int y = 0; y < height; y++)
+            for (int z = 0; z < depth; z++)
+                for (int x = 0; x < width; x++)
+                {
+                    int idx = getIndex(x, y, z);
+                    storedCells.push_back(idx);
+                    if (layout != GridLayout::Linear)
+                        storedCoords[idx] = {(uint16_t)x, (uint16_t)y, (uint16_t)z};
+                }
+        std::sort(storedCells.begin(), storedCells.end());
+        return storageSize;
+    }
+
+    WeightPolicy weights;
+
+    // Position de la grille dans un monde plus grand (solveurs par régions) : décale les
+    // coordonnées vues par la politique de poids et les clés de tirage
+    int originX = 0, originY = 0, originZ = 0;
+
+    // Directions: -X, +X, -Y, +Y, -Z, +Z
+    const int dx[6] = {-1, 1, 0, 0, 0, 0};
+    const int dy[6] = {0, 0, -1, 1, 0, 0};
+    const int dz[6] = {0, 0, 0, 0, -1, 1};
+
+    int tileCount = 0;
+    AdjacencyTable adjacency;
+    PropagationMode propagationMode = PropagationMode::Bitmask;
+
+    // Propagation AC-4 : supports[(cellule * nbTuiles + tuile) * 6 + dir] compte les tuiles
+    // encore possibles dans la cellule voisine (côté -dir) qui autorisent cette tuile ici.
+    // Une tuile n'est retirée que lorsque l'un de ses compteurs tombe à zéro.
+    std::vector<uint16_t> supports;
+    std::vector<DomainMask> pendingRemoved; // Tuiles retirées mais pas encore propagées (mode AC-4)
+
+    // File de propagation : une cellule y est présente au plus une fois (bit CELL_QUEUED)
+    enum CellFlag : uint8_t
+    {
+        CELL_QUEUED = 1,
+        CELL_DIRTY = 2 // Présente dans dirtyCells
+    };
+    std::vector<uint8_t> cellFlags;
+    CellQueue workQueue;
+    long long waveCount = 0;
+    long long processedCount = 0;
+
+    // Cellules fixées (ou défixées par un retour arrière) depuis le dernier drainChanges()
+    std::vector<int> dirtyCells;
+    int collapsedCount = 0;
+
+    void markDirty(int idx)
+    {
+        if (cellFlags[idx] & CELL_DIRTY)
+            return;
+        cellFlags[idx] |= CELL_DIRTY;
+        dirtyCells.push_back(idx);
+    }
+
+    void enqueue(int idx)
+    {
+        if (cellFlags[idx] & CELL_QUEUED)
+            return;
+        cellFlags[idx] |= CELL_QUEUED;
+        workQueue.push(idx);
+    }
+
+    int dequeue()
+    {
+        int idx = workQueue.pop();
+        cellFlags[idx] &= ~CELL_QUEUED;
+        return idx;
+    }
+
+    // Cellules non fixées, ordonnées par entropie (départage aléatoire via tieBreak dans [0, 1[)
+    EntropyHeap entropyHeap;
+    std::vector<float> tieBreak;
+
+    // Balayage : position courante dans l'ordre scanOrder. Tant qu'on balaye, le tas et les sommes
+    // Shannon ne sont plus entretenus (entropyTracked) ; ils sont reconstruits au retour à MinEntropy.
+    SelectionOrder scanOrder = SelectionOrder::Layers;
+    int scanCursor = 0;
+    bool entropyTracked = true;
+
+    // Cellule à la position p de l'ordre de balayage
+    int scanCell(SelectionOrder order, int p) const
+    {
+        if (order == SelectionOrder::Layers)
+        {
+            int layerSize = width * depth;
+            int y = height - 1 - p / layerSize;
+            int rest = p % layerSize;
+            return getIndex(rest % width, y, rest / width);
+        }
+        int column = p / height;
+        int y = height - 1 - p % height;
+        return getIndex(column % width, y, column / width);
+    }
+
+    // Mode Shannon : sommes courantes Σw et Σw·log(w) sur les tuiles encore possibles,
+    // mises à jour en O(1) par tuile retirée
+    EntropyMode entropyMode = EntropyMode::TileCount;
+    std::vector<double> sumWeights;
+    std::vector<double> sumWeightLogs;
+
+    // Tables d'alias du tirage pondéré, partagées entre cellules de même catégorie et même domaine
+    // (politiques qui exposent category(x, y, z) uniquement)
+    AliasCache aliasCache;
+
+    // Poids effectifs (baseWeight × politique) des tuiles de `tiles`, écrits dans out[tileId].
+    // Une politique qui fournit fill() calcule toute la cellule en un seul appel.
+    void cellWeights(int x, int y, int z, const DomainMask &tiles, float *out) const
+    {
+        fillPolicyWeights(weights, x + originX, y + originY, z + originZ, tiles, out);
+        tiles.forEach([&](int tileId) { out[tileId] *= tileSet[tileId].baseWeight; });
+    }
+
+    // Tirage pondéré d'une tuile du domaine avec u uniforme dans [0, 1[, tirage uniforme si aucun
+    // poids n'est exploitable. Avec une politique à catégories, table d'alias en cache : O(1).
+    int pickTile(int x, int y, int z, const DomainMask &domain, float u)
+    {
+        float tileWeights[DomainMask::capacity];
+
+        if constexpr (HasWeightCategory<WeightPolicy>::value)
+        {
+            uint32_t category = (uint32_t)weights.category(x + originX, y + originY, z + originZ);
+            const AliasEntry *entry = aliasCache.find(category, domain);
+            if (!entry)
+            {
+                cellWeights(x, y, z, domain, tileWeights);
+                entry = &aliasCache.insert(category, domain, tileWeights);
+            }
+            return aliasCache.sample(*entry, u);
+        }
+        else
+        {
+            cellWeights(x, y, z, domain, tileWeights);
+
+            int options[DomainMask::capacity];
+            int optionCount = 0;
+            float totalWeight = 0.0f;
+            domain.forEach([&](int tileId)
+            {
+                options[optionCount++] = tileId;
+                if (tileWeights[tileId] > 0.0f)
+                    totalWeight += tileWeights[tileId];
+            });
+
+            // Aucun poids exploitable : tirage uniforme plutôt que toujours la dernière option
+            if (totalWeight <= 0.0f)
+                return options[std::min((int)(u * optionCount), optionCount - 1)];
+
+            float randomValue = u * totalWeight;
+            float currentSum = 0.0f;
+            for (int i = 0; i < optionCount; i++)
+            {
+                float w = tileWeights[options[i]];
+                if (w <= 0.0f)
+                    continue;
+                currentSum += w;
+                if (randomValue < currentSum)
+                    return options[i];
+            }
+            // Arrondi flottant : dernière tuile de poids non nul
+            for (int i = optionCount - 1; i >= 0; i--)
+                if (tileWeights[options[i]] > 0.0f)
+                    return options[i];
+            return options[optionCount - 1];
+        }
+    }
+
+    float cellEntropy(int idx) const
+    {
+        const Cell &cell = grid[idx];
+        if (entropyMode == EntropyMode::TileCount)
+            return (float)cell.entropy();
+
+        double sum = sumWeights[idx];
+        if (cell.possibleTiles.count() <= 1 || sum <= 1e-12)
+            return 0.0f;
+        return (float)std::max(0.0, std::log(sum) - sumWeightLogs[idx] / sum);
+    }
+
+    float entropyKey(int idx) const
+    {
+        float noiseScale = (entropyMode == EntropyMode::TileCount) ? 0.5f : 1e-3f;
+        return cellEntropy(idx) + tieBreak[idx] * noiseScale;
+    }
+
+    // Recalcule les sommes pondérées et les clés du tas depuis les domaines courants
+    void refreshEntropy()
+    {
+        entropyTracked = true;
+        if (entropyMode == EntropyMode::Shannon)
+        {
+            sumWeights.assign(grid.size(), 0.0);
+            sumWeightLogs.assign(grid.size(), 0.0);
+            for (int idx : storedCells)
+                adjustEntropySums(idx, grid[idx].possibleTiles, 1.0);
+        }
+
+        entropyHeap.clear();
+        for (int idx : storedCells)
+        {
+            if (!grid[idx].isCollapsed())
+                entropyHeap.pushUnordered(idx, entropyKey(idx));
+        }
+        entropyHeap.rebuild();
+    }
+
+    // Replace une cellule dans le tas après un changement de domaine (retirée si elle est fixée)
+    void rekeyCell(int idx)
+    {
+        if (grid[idx].isCollapsed())
+            entropyHeap.remove(idx);
+        else if (entropyHeap.contains(idx))
+            entropyHeap.update(idx, entropyKey(idx));
+        else
+            entropyHeap.push(idx, entropyKey(idx));
+    }
+
+    // Clé de tirage d'une cellule : ses coordonnées, indépendantes de l'ordre de résolution
+    uint64_t cellKey(int idx) const
+    {
+        int x, y, z;
+        getCoords(idx, x, y, z);
+        return CounterRng::cellKey(x + originX, y + originY, z + originZ);
+    }
+
+    // En size_t : cellules x tuiles x 6 dépasse 2^31 sur les grandes grilles (128^3 et 512 tuiles)
+    size_t supportIndex(int idx, int tileId, int dir) const
+    {
+        return ((size_t)idx * tileCount + tileId) * 6 + dir;
+    }
+
+    void getCoords(int idx, int &x, int &y, int &z) const
+    {
+        if (layout != GridLayout::Linear)
+        {
+            const StoredCoord &c = storedCoords[idx];
+            x = c.x;
+            y = c.y;
+            z = c.z;
+            return;
+        }
+        y = idx / (width * depth);
+        int rest = idx - y * (width * depth);
+        z = rest / width;
+        x = rest - z * width;
+    }
+
+    bool inBounds(int x, int y, int z) const
+    {
+        return x >= 0 && x < width && y >= 0 && y < height && z >= 0 && z < depth;
+    }
+
+    static int opposite(int dir) { return dir ^ 1; }
+
+    // Compile validNeighbors en masques : ids validés et règles rendues symétriques
+    // (une paire n'est autorisée que si les deux tuiles l'acceptent)
+    void compileRules()
+    {
+        for (int i = 0; i < tileCount; i++)
+        {
+            if (tileSet[i].id != i)
+            {
+                std::cout << "Regles WFC : la tuile d'index " << i << " a l'id " << tileSet[i].id
+                          << ", l'index est utilise" << std::endl;
+                tileSet[i].id = i;
+            }
+        }
+
+        std::vector<DomainMask> declared(6 * tileCount);
+        int invalidIds = 0;
+        for (int tileId = 0; tileId < tileCount; tileId++)
+        {
+            for (int dir = 0; dir < 6; dir++)
+            {
+                for (int id : tileSet[tileId].validNeighbors[dir])
+                {
+                    if (id < 0 || id >= tileCount)
+                        invalidIds++;
+                    else
+                        declared[dir * tileCount + tileId].set(id);
+                }
+            }
+        }
+
+        adjacency.tileCount = tileCount;
+        adjacency.masks.assign(6 * tileCount, DomainMask());
+        int asymmetric = 0;
+        for (int dir = 0; dir < 6; dir++)
+        {
+            for (int tileId = 0; tileId < tileCount; tileId++)
+            {
+                declared[dir * tileCount + tileId].forEach([&](int nbTileId)
+                {
+                    if (declared[opposite(dir) * tileCount + nbTileId].test(tileId))
+                        adjacency.masks[dir * tileCount + tileId].set(nbTileId);
+                    else
+                        asymmetric++;
+                });
+            }
+        }
+
+        if (invalidIds > 0)
+            std::cout << "Regles WFC : " << invalidIds << " voisins avec un id invalide ignores" << std::endl;
+        if (asymmetric > 0)
+            std::cout << "Regles WFC : " << asymmetric << " adjacences non reciproques ignorees" << std::endl;
+    }
+
+    // Recalcule tous les compteurs AC-4 depuis les domaines courants
+    void rebuildSupports()
+    {
+        supports.assign(grid.size() * tileCount * 6, 0);
+        for (int idx : storedCells)
+        {
+            int x, y, z;
+            getCoords(idx, x, y, z);
+            for (int dir = 0; dir < 6; dir++)
+            {
+                int sx = x - dx[dir];
+                int sy = y - dy[dir];
+                int sz = z - dz[dir];
+                if (!inBounds(sx, sy, sz))
+                    continue;
+                grid[getIndex(sx, sy, sz)].possibleTiles.forEach([&](int myTileId)
+                {
+                    adjacency.mask(dir, myTileId).forEach([&](int nbTileId)
+                    {
+                        supports[supportIndex(idx, nbTileId, dir)]++;
+                    });
+                });
+            }
+        }
+    }
+
+    // Tuiles de la cellule sans plus aucun support dans au moins une direction (mode AC-4)
+    DomainMask unsupportedTiles(int idx) const
+    {
+        int x, y, z;
+        getCoords(idx, x, y, z);
+        DomainMask unsupported;
+        for (int dir = 0; dir < 6; dir++)
+        {
+            if (!inBounds(x - dx[dir], y - dy[dir], z - dz[dir]))
+                continue;
+            grid[idx].possibleTiles.forEach([&](int tileId)
+            {
+                if (supports[supportIndex(idx, tileId, dir)] == 0)
+                    unsupported.set(tileId);
+            });
+        }
+        return unsupported;
+    }
+
+    // Retour arrière : chaque décision de step() ouvre un niveau, et la première modification
+    // d'une cellule dans ce niveau enregistre son état précédent dans la piste (trail).
+    // Annuler une décision ne coûte que le nombre de cellules modifiées depuis.
+    struct TrailEntry
+    {
+        int idx;
+        int prevCollapsed;
+        DomainMask prevDomain;
+    };
+
+    struct Decision
+    {
+        size_t trailMark; // Position absolue dans la piste au moment de la décision
+        uint32_t level;   // Identifiant unique du niveau
+        int idx;
+        int tileId;
+        SelectionOrder scanOrder; // Balayage à restaurer
+        int scanCursor;
+    };
+
+    std::deque<TrailEntry> trail;
+    size_t trailBase = 0; // Position absolue de trail.front()
+    std::deque<Decision> decisions;
+    std::vector<uint32_t> trailStamp; // Dernier niveau ayant enregistré chaque cellule
+    uint32_t levelCounter = 0;
+    int maxBacktrackDepth = 0; // 0 = pas de retour arrière
+    int maxBacktrackRetries = 0;
+    int backtrackCount = 0;
+
+    // Réparation locale : quand le retour arrière ne suffit plus, un cube de rayon repairRadius
+    // autour de la contradiction retrouve ses domaines de départ puis est résolu à nouveau
+    std::vector<DomainMask> initialDomains; // Domaine de départ de chaque cellule (contraintes comprises)
+    int conflictIdx = -1;                   // Dernière cellule dont le domaine s'est vidé
+    int repairRadius = 0;                   // 0 = pas de réparation
+    int maxRepairs = 0;
+    int repairCount = 0;
+
+    void recordCell(int idx)
+    {
+        if (decisions.empty())
+            return; // Aucune décision à annuler
+        uint32_t level = decisions.back().level;
+        if (trailStamp[idx] == level)
+            return;
+        trailStamp[idx] = level;
+        trail.push_back({idx, grid[idx].collapsedTile, grid[idx].possibleTiles});
+    }
+
+    void pushDecision(int idx, int tileId)
+    {
+        if (maxBacktrackDepth <= 0)
+            return;
+        decisions.push_back({trailBase + trail.size(), ++levelCounter, idx, tileId, scanOrder, scanCursor});
+        trimDecisions(maxBacktrackDepth);
+    }
+
+    // Profondeur bornée : on oublie les décisions les plus anciennes et leur partie de piste
+    void trimDecisions(int maxDepth)
+    {
+        while ((int)decisions.size() > std::max(maxDepth, 0))
+        {
+            decisions.pop_front();
+            size_t keep = decisions.empty() ? trailBase + trail.size() : decisions.front().trailMark;
+            while (trailBase < keep)
+            {
+                trail.pop_front();
+                trailBase++;
+            }
+        }
+    }
+
+    void clearTrail()
+    {
+        trailBase += trail.size();
+        trail.clear();
+        decisions.clear();
+    }
+
+    // Vide la file de propagation sans rien interdire (les compteurs AC-4 restent exacts)
+    void discardPending()
+    {
+        while (!workQueue.empty())
+        {
+            int idx = dequeue();
+            DomainMask removed = pendingRemoved[idx];
+            pendingRemoved[idx].clear();
+            if (propagationMode == PropagationMode::SupportCount)
+                adjustSupports(idx, removed, -1);
+        }
+    }
+
+    // Met à jour les compteurs AC-4 des voisins quand des tuiles quittent (-1) ou retrouvent (+1) une cellule
+    void adjustSupports(int idx, const DomainMask &tiles, int delta)
+    {
+        int x, y, z;
+        getCoords(idx, x, y, z);
+        for (int dir = 0; dir < 6; dir++)
+        {
+            int nx = x + dx[dir];
+            int ny = y + dy[dir];
+            int nz = z + dz[dir];
+            if (!inBounds(nx, ny, nz))
+                continue;
+            int nIdx = getIndex(nx, ny, nz);
+            tiles.forEach([&](int myTileId)
+            {
+                adjacency.mask(dir, myTileId).forEach([&](int nbTileId)
+                {
+                    supports[supportIndex(nIdx, nbTileId, dir)] += delta;
+                });
+            });
+        }
+    }
+
+    // Restaure la piste jusqu'à une position absolue, en ordre inverse
+    void rollbackTo(size_t mark)
+    {
+        while (trailBase + trail.size() > mark)
+        {
+            TrailEntry entry = trail.back();
+            trail.pop_back();
+
+            Cell &cell = grid[entry.idx];
+            if (cell.collapsedTile != entry.prevCollapsed)
+            {
+                markDirty(entry.idx);
+                collapsedCount += (entry.prevCollapsed != -1) - cell.isCollapsed();
+            }
+            DomainMask restored = entry.prevDomain.without(cell.possibleTiles);
+            cell.possibleTiles = entry.prevDomain;
+            cell.collapsedTile = entry.prevCollapsed;
+
+            adjustEntropySums(entry.idx, restored, 1.0);
+            if (propagationMode == PropagationMode::SupportCount)
+                adjustSupports(entry.idx, restored, 1);
+
+            if (entropyTracked)
+                rekeyCell(entry.idx);
+        }
+    }
+
+    // Après une contradiction : annule la dernière décision et interdit la tuile choisie,
+    // en remontant plus haut si cette interdiction mène elle aussi à une contradiction
+    bool backtrack()
+    {
+        while (failed)
+        {
+            if (decisions.empty() || backtrackCount >= maxBacktrackRetries)
+                return false;
+
+            Decision decision = decisions.back();
+            decisions.pop_back();
+            discardPending();
+            rollbackTo(decision.trailMark);
+            backtrackCount++;
+            failed = false;
+            scanOrder = decision.scanOrder;
+            scanCursor = decision.scanCursor;
+
+            DomainMask banned;
+            banned.set(decision.tileId);
+            if (removeTiles(decision.idx, banned))
+                propagate();
+        }
+        return true;
+    }
+
+    // Retire des tuiles du domaine d'une cellule et planifie leur propagation
+    bool removeTiles(int idx, const DomainMask &toRemove)
+    {
+        Cell &cell = grid[idx];
+        DomainMask removed = cell.possibleTiles & toRemove;
+        if (removed.empty())
+            return true;
+
+        recordCell(idx);
+        cell.possibleTiles = cell.possibleTiles.without(removed);
+        adjustEntropySums(idx, removed, -1.0);
+
+        // Une seule possibilité restante : la cellule est fixée dès maintenant
+        if (!cell.isCollapsed() && cell.possibleTiles.count() == 1)
+        {
+            cell.collapsedTile = cell.possibleTiles.first();
+            collapsedCount++;
+            markDirty(idx);
+            if (entropyTracked)
+                entropyHeap.remove(idx);
+        }
+        else if (entropyTracked && entropyHeap.contains(idx))
+            entropyHeap.update(idx, entropyKey(idx));
+        if (propagationMode == PropagationMode::SupportCount)
+            pendingRemoved[idx] |= removed;
+        enqueue(idx);
+
+        if (cell.possibleTiles.empty())
+        {
+            failed = true; // Contradiction
+            conflictIdx = idx;
+            return false;
+        }
+        return true;
+    }
+
+    // Ajoute (sign = 1) ou retire (sign = -1) des tuiles des sommes pondérées du mode Shannon
+    void adjustEntropySums(int idx, const DomainMask &tiles, double sign)
+    {
+        if (entropyMode != EntropyMode::Shannon || !entropyTracked)
+            return;
+        int x, y, z;
+        getCoords(idx, x, y, z);
+        float tileWeights[DomainMask::capacity];
+        cellWeights(x, y, z, tiles, tileWeights);
+        tiles.forEach([&](int tileId)
+        {
+            double w = tileWeights[tileId];
+            if (w > 0.0)
+            {
+                sumWeights[idx] += sign * w;
+                sumWeightLogs[idx] += sign * w * std::log(w);
+            }
+        });
+    }
+
+    // Fixe une cellule sur une tuile et la sort du tas d'entropie
+    void commitTile(int idx, int tileId)
+    {
+        recordCell(idx);
+        if (entropyTracked)
+            entropyHeap.remove(idx);
+        DomainMask others = grid[idx].possibleTiles;
+        others.reset(tileId);
+        removeTiles(idx, others);
+        grid[idx].collapsedTile = tileId;
+        markDirty(idx);
+    }
+
+    void propagate()
+    {
+        if (!workQueue.empty())
+            waveCount++;
+
+        while (!workQueue.empty() && !failed)
+        {
+            int idx = dequeue();
+            processedCount++;
+
+            DomainMask removed = pendingRemoved[idx];
+            pendingRemoved[idx].clear();
+
+            int cx, cy, cz;
+            getCoords(idx, cx, cy, cz);
+            const DomainMask &myTiles = grid[idx].possibleTiles;
+
+            // Pour chaque voisin
+            for (int dir = 0; dir < 6; dir++)
+            {
+                int nx = cx + dx[dir];
+                int ny = cy + dy[dir];
+                int nz = cz + dz[dir];
+
+                if (!inBounds(nx, ny, nz))
+                    continue;
+
+                int nIdx = getIndex(nx, ny, nz);
+                const DomainMask &nbTiles = grid[nIdx].possibleTiles;
+                DomainMask unsupported;
+
+                if (propagationMode == PropagationMode::Bitmask)
+                {
+                    // Le voisin ne garde que les tuiles autorisées par au moins une tuile restante ici
+                    unsupported = nbTiles.without(adjacency.allowed(dir, myTiles));
+                }
+                else
+                {
+                    // Chaque tuile retirée ici retire un support à ses tuiles compatibles chez le voisin
+                    removed.forEach([&](int myTileId)
+                    {
+                        adjacency.mask(dir, myTileId).forEach([&](int nbTileId)
+                        {
+                            if (--supports[supportIndex(nIdx, nbTileId, dir)] == 0 && nbTiles.test(nbTileId))
+                                unsupported.set(nbTileId);
+                        });
+                    });
+                }
 
-    int getIndex(int x, int y, int z) const
-    {
-        return y * (width * depth) + z * width + x;
+                // En cas de contradiction on termine quand même cette cellule : ses compteurs restent exacts
+                if (!unsupported.empty())
+                    removeTiles(nIdx, unsupported);
+            }
+        }
     }
 
-    WeightFunc weightOverride = nullptr;
+    // Collapse spéculatif (stepBatch) : la vague d'une cellule est calculée à part, sur une copie
+    // locale des domaines d'un cube de rayon speculationRadius (écriture) bordé d'une couche
+    // en lecture seule. Si la vague doit sortir du cube ou vide un domaine, elle est abandonnée.
+    struct SpeculativeWave
+    {
+        int idx;
+        int tileId;
+        bool ok;
+        std::vector<std::pair<int, DomainMask>> changes; // Domaines finaux des cellules modifiées (hors idx)
+    };
 
-    // Directions: -X, +X, -Y, +Y, -Z, +Z
-    const int dx[6] = {-1, 1, 0, 0, 0, 0};
-    const int dy[6] = {0, 0, -1, 1, 0, 0};
-    const int dz[6] = {0, 0, 0, 0, -1, 1};
+    int speculationRadius = 4;
+    long long speculativeCommits = 0;
+    long long speculativeConflicts = 0;
 
-    void propagate(int startX, int startY, int startZ)
+    // Ne lit que la grille et les règles : appelable en parallèle tant que personne n'écrit
+    void speculate(SpeculativeWave &wave) const
     {
-        std::vector<std::tuple<int, int, int>> stack;
-        stack.push_back({startX, startY, startZ});
+        wave.ok = false;
+        wave.changes.clear();
+
+        int sx, sy, sz;
+        getCoords(wave.idx, sx, sy, sz);
+        int r = speculationRadius;
+        int side = 2 * r + 3;
+        int ox = sx - r - 1, oy = sy - r - 1, oz = sz - r - 1;
+
+        enum : uint8_t
+        {
+            LOADED = 1,
+            QUEUED = 2,
+            CHANGED = 4
+        };
+        // Tampons réutilisés d'une vague à l'autre par chaque thread ; seules les entrées
+        // touchées sont remises à zéro en sortie
+        thread_local std::vector<DomainMask> local;
+        thread_local std::vector<uint8_t> state;
+        thread_local std::vector<int> queue;
+        thread_local std::vector<int> touched;
+        local.resize(side * side * side);
+        state.resize(side * side * side, 0);
+        queue.clear();
+        struct ClearOnExit
+        {
+            std::vector<uint8_t> &state;
+            std::vector<int> &touched;
+            ~ClearOnExit()
+            {
+                for (int li : touched)
+                    state[li] = 0;
+                touched.clear();
+            }
+        };
+        ClearOnExit clearOnExit{state, touched};
 
-        while (!stack.empty())
+        auto localIndex = [&](int x, int y, int z) { return ((y - oy) * side + (z - oz)) * side + (x - ox); };
+        auto load = [&](int x, int y, int z) -> DomainMask &
         {
-            auto [cx, cy, cz] = stack.back();
-            stack.pop_back();
+            int li = localIndex(x, y, z);
+            if (!(state[li] & LOADED))
+            {
+                local[li] = grid[getIndex(x, y, z)].possibleTiles;
+                state[li] |= LOADED;
+                touched.push_back(li);
+            }
+            return local[li];
+        };
 
-            Cell &currentCell = grid[getIndex(cx, cy, cz)];
+        DomainMask &seed = load(sx, sy, sz);
+        seed.clear();
+        seed.set(wave.tileId);
+        int seedLocal = localIndex(sx, sy, sz);
+        state[seedLocal] |= QUEUED;
+        queue.push_back(seedLocal);
+
+        for (size_t head = 0; head < queue.size(); head++)
+        {
+            int li = queue[head];
+            state[li] &= ~QUEUED;
+            int cx = ox + li % side;
+            int cz = oz + (li / side) % side;
+            int cy = oy + li / (side * side);
+            const DomainMask myTiles = local[li];
 
-            // Pour chaque voisin
             for (int dir = 0; dir < 6; dir++)
             {
                 int nx = cx + dx[dir];
                 int ny = cy + dy[dir];
                 int nz = cz + dz[dir];
-
-                if (nx < 0 || nx >= width || ny < 0 || ny >= height || nz < 0 || nz >= depth)
+                if (!inBounds(nx, ny, nz))
                     continue;
 
-                Cell &neighbor = grid[getIndex(nx, ny, nz)];
-                if (neighbor.isCollapsed())
-                    continue; // Déjà fixé
+                DomainMask &nbTiles = load(nx, ny, nz);
+                DomainMask unsupported = nbTiles.without(adjacency.allowed(dir, myTiles));
+                if (unsupported.empty())
+                    continue;
 
-                // Quelles sont les tuiles possibles pour le voisin, étant donné les options actuelles de 'currentCell' ?
-                std::set<int> allowedNeighborTiles;
+                // Hors du cube d'écriture, ou contradiction : la vague sera rejouée en série
+                if (std::abs(nx - sx) > r || std::abs(ny - sy) > r || std::abs(nz - sz) > r)
+                    return;
+                nbTiles = nbTiles.without(unsupported);
+                if (nbTiles.empty())
+                    return;
 
-                for (int myTileId : currentCell.possibleTiles)
+                int nLocal = localIndex(nx, ny, nz);
+                state[nLocal] |= CHANGED;
+                if (!(state[nLocal] & QUEUED))
                 {
-                    // Si myTileId est invalide on ignore
-                    if (myTileId >= tileSet.size())
-                        continue;
-
-                    const auto &valid = tileSet[myTileId].validNeighbors[dir];
-                    allowedNeighborTiles.insert(valid.begin(), valid.end());
+                    state[nLocal] |= QUEUED;
+                    queue.push_back(nLocal);
                 }
+            }
+        }
 
-                // Intersection : On ne garde que ce qui était déjà possible et qui est autorisé par le cas présent
-                std::vector<int> toRemove;
-                for (int nbTileId : neighbor.possibleTiles)
-                {
-                    if (allowedNeighborTiles.find(nbTileId) == allowedNeighborTiles.end())
-                    {
-                        toRemove.push_back(nbTileId);
-                    }
-                }
+        for (int li : touched)
+        {
+            if (!(state[li] & CHANGED) || li == seedLocal)
+                continue;
+            int x = ox + li % side;
+            int z = oz + (li / side) % side;
+            int y = oy + li / (side * side);
+            wave.changes.push_back({getIndex(x, y, z), local[li]});
+        }
+        wave.ok = true;
+    }
 
-                if (!toRemove.empty())
-                {
-                    for (int id : toRemove)
-                        neighbor.possibleTiles.erase(id);
+    // Fixe une cellule en série, comme step() : nouvelle décision, propagation, retour arrière
+    bool collapseSerial(int idx, int tileId)
+    {
+        pushDecision(idx, tileId);
+        commitTile(idx, tileId);
+        propagate();
+        if (failed && !backtrack())
+            return repairContradiction();
+        return true;
+    }
 
-                    if (neighbor.possibleTiles.empty())
-                    {
-                        failed = true; // Contradiction
-                        return;
-                    }
-                    stack.push_back({nx, ny, nz});
-                }
+    // Position d'une cellule dans l'ordre de balayage (inverse de scanCell)
+    int scanPosition(SelectionOrder order, int idx) const
+    {
+        int x, y, z;
+        getCoords(idx, x, y, z);
+        if (order == SelectionOrder::Layers)
+            return (height - 1 - y) * (width * depth) + z * width + x;
+        return (z * width + x) * height + (height - 1 - y);
+    }
+
+    // Rouvre le cube de rayon `radius` autour de `center` : domaines de départ, puis propagation.
+    // La file de propagation en cours est conservée : les compteurs AC-4 restent exacts.
+    void reopenAround(int center, int radius)
+    {
+        clearTrail(); // Les décisions enregistrées ne décrivent plus la grille
+        failed = false;
+
+        int cx, cy, cz;
+        getCoords(center, cx, cy, cz);
+        std::vector<int> region;
+        for (int y = std::max(0, cy - radius); y <= std::min(height - 1, cy + radius); y++)
+            for (int z = std::max(0, cz - radius); z <= std::min(depth - 1, cz + radius); z++)
+                for (int x = std::max(0, cx - radius); x <= std::min(width - 1, cx + radius); x++)
+                    region.push_back(getIndex(x, y, z));
+
+        for (int idx : region)
+        {
+            Cell &cell = grid[idx];
+            const DomainMask &initial = initialDomains[idx];
+            DomainMask added = initial.without(cell.possibleTiles);
+            int previousTile = cell.collapsedTile;
+
+            cell.possibleTiles = initial;
+            cell.collapsedTile = (initial.count() == 1) ? initial.first() : -1;
+            if (cell.collapsedTile != previousTile)
+            {
+                markDirty(idx);
+                collapsedCount += cell.isCollapsed() - (previousTile != -1);
+            }
+            adjustEntropySums(idx, added, 1.0);
+            if (propagationMode == PropagationMode::SupportCount)
+            {
+                // Les tuiles encore en attente de propagation comptent toujours chez les voisins
+                adjustSupports(idx, added.without(pendingRemoved[idx]), 1);
+                pendingRemoved[idx].clear();
+            }
+
+            if (entropyTracked)
+                rekeyCell(idx);
+            else
+                scanCursor = std::min(scanCursor, scanPosition(scanOrder, idx));
+        }
+
+        // Les voisins hors du cube n'ont rien à craindre (le cube n'a fait que s'élargir) :
+        // seul le cube est restreint par eux
+        if (propagationMode == PropagationMode::Bitmask)
+        {
+            for (int idx : region)
+            {
+                int x, y, z;
+                getCoords(idx, x, y, z);
+                enqueue(idx);
+                for (int dir = 0; dir < 6; dir++)
+                    if (inBounds(x + dx[dir], y + dy[dir], z + dz[dir]))
+                        enqueue(getIndex(x + dx[dir], y + dy[dir], z + dz[dir]));
+            }
+        }
+        else
+        {
+            for (int idx : region)
+            {
+                if (!removeTiles(idx, unsupportedTiles(idx)))
+                    break;
             }
         }
+        propagate();
+    }
+
+    // Réparations successives, cube doublé à chaque nouvel échec (jusqu'à quatre fois)
+    bool repairContradiction()
+    {
+        for (int attempt = 0; failed && attempt < 4; attempt++)
+        {
+            if (repairRadius <= 0 || repairCount >= maxRepairs || conflictIdx < 0)
+                return false;
+            repairCount++;
+            reopenAround(conflictIdx, repairRadius << attempt);
+        }
+        return !failed;
+    }
+
+    // Empreinte des règles compilées (nombre de tuiles et masques d'adjacence)
+    uint64_t rulesHash() const
+    {
+        uint64_t h = splitmix64((uint64_t)tileCount);
+        for (const DomainMask &mask : adjacency.masks)
+            for (uint64_t word : mask.words)
+                h = splitmix64(h ^ word);
+        return h;
     }
 
 public:
-    WFCEngine(int w, int h, int d, const std::vector<TileRule> &tiles, unsigned int seed)
-        : width(w), height(h), depth(d), tileSet(tiles), rng(seed)
+    BasicWFCEngine(int w, int h, int d, const std::vector<TileRule> &tiles, unsigned int seed,
+                   WeightPolicy policy = WeightPolicy(), GridLayout gridLayout = GridLayout::Linear)
+        : width(w), height(h), depth(d), tileSet(tiles), rng(seed), layout(gridLayout), weights(std::move(policy))
     {
+        if ((int)tileSet.size() > DomainMask::capacity)
+        {
+            std::cout << "Erreur WFC : " << tileSet.size() << " tuiles, maximum " << DomainMask::capacity
+                      << " (recompiler avec un WFC_MAX_TILES plus grand)" << std::endl;
+            configError = true;
+        }
+
+        grid.resize(buildLayout());
+        if (!configError)
+        {
+            tileCount = (int)tileSet.size();
+            compileRules();
 
-        grid.resize(width * height * depth);
+            // Au-delà d'un mot, les compteurs coûtent moins cher que l'union des masques
+            propagationMode = (tileCount <= 64) ? PropagationMode::Bitmask : PropagationMode::SupportCount;
+            pendingRemoved.resize(grid.size());
+            entropyHeap.resize((int)grid.size());
+            tieBreak.resize(grid.size());
+            attempts.resize(grid.size());
+            trailStamp.resize(grid.size());
+            cellFlags.resize(grid.size());
+            initialDomains.resize(grid.size());
+        }
         reset();
     }
 
-    void reset()
+    void reset() { reset(nullptr); }
+
+    // Réinitialise avec un domaine de départ par cellule (tableau contigu de width*height*depth
+    // masques, dans l'ordre de linearIndex quelle que soit la disposition mémoire), suivi d'une
+    // seule passe globale d'arc-consistance.
+    // perCell == nullptr : toutes les tuiles partout.
+    void reset(const DomainMask *perCell)
     {
-        failed = false;
-        for (auto &cell : grid)
+        failed = configError;
+        if (configError)
+            return;
+
+        DomainMask allTiles;
+        allTiles.fill(tileCount);
+
+        collapsedCount = 0;
+        for (int idx : storedCells)
         {
-            cell.collapsedTile = -1;
-            cell.possibleTiles.clear();
-            for (const auto &tile : tileSet)
+            Cell &cell = grid[idx];
+            if (perCell)
+            {
+                int x, y, z;
+                getCoords(idx, x, y, z);
+                cell.possibleTiles = perCell[linearIndex(x, y, z)] & allTiles;
+            }
+            else
+                cell.possibleTiles = allTiles;
+            initialDomains[idx] = cell.possibleTiles;
+            cell.collapsedTile = (cell.possibleTiles.count() == 1) ? cell.possibleTiles.first() : -1;
+            collapsedCount += cell.isCollapsed();
+            if (cell.possibleTiles.empty())
+                failed = true; // Domaine de départ vide
+            markDirty(idx); // Toute la grille est à relire
+        }
+        for (auto &pending : pendingRemoved)
+            pending.clear();
+        while (!workQueue.empty())
+            dequeue();
+        waveCount = 0;
+        processedCount = 0;
+        workQueue.resetStats();
+        clearTrail();
+        backtrackCount = 0;
+        repairCount = 0;
+        conflictIdx = -1;
+        scanCursor = 0;
+
+        for (int idx : storedCells)
+            tieBreak[idx] = rng.unit(cellKey(idx), 0, RNG_TIE_BREAK);
+        std::fill(attempts.begin(), attempts.end(), 0u);
+        refreshEntropy();
+
+        if (perCell)
+        {
+            initialConsistency();
+            return;
+        }
+
+        DomainMask unsupported[6];
+        for (int dir = 0; dir < 6; dir++)
+            unsupported[dir] = allTiles.without(adjacency.allowed(dir, allTiles));
+
+        if (propagationMode == PropagationMode::SupportCount)
+        {
+            // Supports initiaux : toutes les tuiles du voisin sont encore possibles
+            std::vector<uint16_t> fullSupport(tileCount * 6, 0);
+            for (int dir = 0; dir < 6; dir++)
+                for (int myTileId = 0; myTileId < tileCount; myTileId++)
+                    adjacency.mask(dir, myTileId).forEach([&](int nbTileId) { fullSupport[nbTileId * 6 + dir]++; });
+
+            supports.resize(grid.size() * tileCount * 6);
+            for (size_t idx = 0; idx < grid.size(); idx++)
+                std::copy(fullSupport.begin(), fullSupport.end(), supports.begin() + idx * tileCount * 6);
+        }
+
+        // Une tuile qu'aucune tuile voisine n'autorise est impossible dès le départ
+        for (int idx : storedCells)
+        {
+            int x, y, z;
+            getCoords(idx, x, y, z);
+            for (int dir = 0; dir < 6; dir++)
             {
-                cell.possibleTiles.insert(tile.id);
+                if (!unsupported[dir].empty() && inBounds(x - dx[dir], y - dy[dir], z - dz[dir]))
+                    removeTiles(idx, unsupported[dir]);
             }
         }
+        propagate();
     }
 
-    void setWeightFunction(WeightFunc func) { weightOverride = func; }
+    // Passe d'arc-consistance globale depuis des domaines quelconques
+    void initialConsistency()
+    {
+        if (propagationMode == PropagationMode::Bitmask)
+        {
+            // Chaque cellule restreint ses voisins une fois, puis la propagation suit les changements
+            for (int idx : storedCells)
+                enqueue(idx);
+        }
+        else
+        {
+            rebuildSupports();
+            for (int idx : storedCells)
+                removeTiles(idx, unsupportedTiles(idx));
+        }
+        propagate();
+    }
+
+    // Nouvelle graine : prise en compte au prochain reset()
+    void setSeed(unsigned int seed) { rng = CounterRng(seed); }
+
+    // Origine de la grille dans le monde : prise en compte au prochain reset(). La cellule locale
+    // (x, y, z) est vue comme la cellule (origine + x, y, z) du monde par la politique de poids et par
+    // le générateur, dont les tirages sont indexés par cellule : deux moteurs de même graine qui
+    // couvrent la même cellule du monde y tirent les mêmes nombres.
+    void setOrigin(int x, int y, int z)
+    {
+        originX = x;
+        originY = y;
+        originZ = z;
+    }
+
+    void setWeightPolicy(WeightPolicy policy)
+    {
+        weights = std::move(policy);
+        aliasCache.clear();
+        if (!configError && entropyMode == EntropyMode::Shannon)
+            refreshEntropy();
+    }
+
+    // Uniquement pour les politiques construites depuis une WeightFunc (FunctionWeights)
+    void setWeightFunction(WeightFunc func) { setWeightPolicy(WeightPolicy(std::move(func))); }
+
+    const WeightPolicy &getWeightPolicy() const { return weights; }
+
+    // Change de stratégie de propagation en cours de résolution (les compteurs sont reconstruits)
+    void setPropagationMode(PropagationMode mode)
+    {
+        if (configError || mode == propagationMode)
+            return;
+        propagate(); // Rien ne doit rester en attente d'une stratégie à l'autre
+        propagationMode = mode;
+        if (mode == PropagationMode::SupportCount)
+            rebuildSupports();
+        else
+            std::vector<uint16_t>().swap(supports);
+    }
+
+    // Retour arrière sur contradiction : jusqu'à maxDepth décisions annulables,
+    // et au plus maxRetries annulations au total (0 désactive)
+    void setBacktracking(int maxDepth, int maxRetries)
+    {
+        maxBacktrackDepth = maxDepth;
+        maxBacktrackRetries = maxRetries;
+        trimDecisions(maxDepth);
+    }
+
+    void setEntropyMode(EntropyMode mode)
+    {
+        entropyMode = mode;
+        if (!configError)
+            refreshEntropy();
+    }
 
     // Force une cellule à un état spécifique
     bool forceCollapse(int x, int y, int z, int tileId)
@@ -143,14 +1294,14 @@ public:
             return false; // Ne pas continuer si déjà en échec
 
         int idx = getIndex(x, y, z);
-        if (grid[idx].possibleTiles.find(tileId) == grid[idx].possibleTiles.end())
+        if (tileId < 0 || tileId >= tileCount || !grid[idx].possibleTiles.test(tileId))
             return false;
 
-        grid[idx].possibleTiles.clear();
-        grid[idx].possibleTiles.insert(tileId);
-        grid[idx].collapsedTile = tileId;
+        clearTrail(); // Contrainte de l'utilisateur : jamais annulée par le retour arrière
+        commitTile(idx, tileId);
+        initialDomains[idx] = grid[idx].possibleTiles; // Contrainte gardée par la réparation locale
 
-        propagate(x, y, z);
+        propagate();
         return !failed;
     }
 
@@ -164,149 +1315,534 @@ public:
         Cell &cell = grid[idx];
 
         // Si la tuile n'est déjà pas possible, on ne fait rien
-        if (cell.possibleTiles.find(tileId) == cell.possibleTiles.end())
+        if (tileId < 0 || tileId >= tileCount || !cell.possibleTiles.test(tileId))
             return true;
 
-        // On retire la tuile
-        cell.possibleTiles.erase(tileId);
+        // On retire la tuile (si c'était la dernière possibilité, c'est un échec ;
+        // s'il n'en reste qu'une, la cellule est marquée collapsed)
+        DomainMask banned;
+        banned.set(tileId);
+        clearTrail(); // Contrainte de l'utilisateur : jamais annulée par le retour arrière
+        initialDomains[idx].reset(tileId);
+        if (!removeTiles(idx, banned))
+            return false;
 
-        // Sécurité : Si c'était la dernière possibilité, c'est un échec
-        if (cell.possibleTiles.empty())
+        // On propage ce changement aux voisins
+        propagate();
+
+        return !failed;
+    }
+
+    // Pré-passe : évalue le poids de chaque tuile possible dans chaque cellule et interdit
+    // celles de poids nul, puis propage. Une cellule dont toutes les tuiles ont un poids nul
+    // est laissée intacte (elle sera tirée uniformément).
+    bool pruneZeroWeights()
+    {
+        if (failed)
+            return false;
+        clearTrail(); // Interdictions définitives, comme banTile()
+
+        for (int idx : storedCells)
         {
-            failed = true;
+            Cell &cell = grid[idx];
+            if (cell.isCollapsed())
+                continue;
+
+            int x, y, z;
+            getCoords(idx, x, y, z);
+            float tileWeights[DomainMask::capacity];
+            cellWeights(x, y, z, cell.possibleTiles, tileWeights);
+
+            DomainMask zeroWeight;
+            cell.possibleTiles.forEach([&](int tileId)
+            {
+                if (tileWeights[tileId] <= 0.0f)
+                    zeroWeight.set(tileId);
+            });
+
+            if (zeroWeight != cell.possibleTiles)
+            {
+                initialDomains[idx] = initialDomains[idx].without(zeroWeight);
+                removeTiles(idx, zeroWeight);
+            }
+        }
+
+        propagate();
+        return !failed;
+    }
+
+    // Une seule étape de l'algo. Les ordres de balayage (Layers, Columns) ne cherchent pas
+    // l'entropie minimale : adaptés aux jeux de règles stratifiés, résolus en une passe linéaire.
+    // Ils économisent le tas et les sommes Shannon, pas la propagation : elle reste complète
+    // (arc-consistance sur toute la grille), pas limitée au front de balayage, pour ne pas
+    // laisser passer de contradiction.
+    bool step(SelectionOrder order = SelectionOrder::MinEntropy)
+    {
+        if (failed)
             return false;
+
+        int targetIdx;
+        if (order == SelectionOrder::MinEntropy)
+        {
+            // Entropie Min : le tas donne directement la cellule la moins incertaine
+            if (!entropyTracked)
+                refreshEntropy();
+            if (entropyHeap.empty())
+                return false; // Tout est fini
+            targetIdx = entropyHeap.top();
+        }
+        else
+        {
+            // Balayage : première cellule non fixée à partir du curseur
+            entropyTracked = false;
+            if (order != scanOrder)
+            {
+                scanOrder = order;
+                scanCursor = 0;
+            }
+            int cellCount = (int)storedCells.size();
+            while (scanCursor < cellCount && grid[scanCell(order, scanCursor)].isCollapsed())
+                scanCursor++;
+            if (scanCursor == cellCount)
+                return false; // Tout est fini
+            targetIdx = scanCell(order, scanCursor);
         }
 
-        // Si on a réduit les possibilités à 1 seule, on marque comme collapsed
-        if (cell.possibleTiles.size() == 1)
+        // 2. Collapse
+        int tx, ty, tz;
+        getCoords(targetIdx, tx, ty, tz);
+        Cell &target = grid[targetIdx];
+
+        // Domaine vide non signalé : on ne tire jamais dans le vide, on répare (ou on échoue)
+        if (target.possibleTiles.empty())
         {
-            cell.collapsedTile = *cell.possibleTiles.begin();
+            failed = true;
+            conflictIdx = targetIdx;
+            return repairContradiction();
         }
 
-        // On propage ce changement aux voisins
-        propagate(x, y, z);
+        float u = rng.unit(cellKey(targetIdx), attempts[targetIdx]++, RNG_COLLAPSE);
+        int pickedTile = pickTile(tx, ty, tz, target.possibleTiles, u);
 
-        return !failed;
+        // 3. Propagate (contradiction : on revient sur les dernières décisions si c'est permis)
+        return collapseSerial(targetIdx, pickedTile);
+    }
+
+    // Enchaîne les step() tant que stop(stats) renvoie false et qu'il reste une cellule à fixer
+    template <typename StopPredicate>
+    RunStats runUntil(StopPredicate &&stop, SelectionOrder order = SelectionOrder::MinEntropy)
+    {
+        auto start = std::chrono::steady_clock::now();
+        RunStats stats;
+        stats.totalCells = getCellCount();
+        stats.collapsedCells = collapsedCount;
+        stats.failed = failed;
+        stats.finished = !failed && collapsedCount == stats.totalCells;
+
+        while (!stats.failed && !stats.finished && !stop(static_cast<const RunStats &>(stats)))
+        {
+            bool progressed = step(order);
+            stats.steps++;
+            stats.collapsedCells = collapsedCount;
+            stats.failed = failed;
+            stats.finished = !failed && (!progressed || collapsedCount == stats.totalCells);
+            stats.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        }
+        stats.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        return stats;
+    }
+
+    // Autant de step() que le budget le permet (le dernier step() peut le dépasser)
+    RunStats runFor(std::chrono::microseconds budget, SelectionOrder order = SelectionOrder::MinEntropy)
+    {
+        return runUntil([budget](const RunStats &stats) { return stats.elapsed >= budget; }, order);
+    }
+
+    // Remplit out avec les cellules dont l'état fixé a changé depuis le dernier appel
+    // (après reset() : toutes les cellules), chacune une seule fois, puis vide la liste
+    void drainChanges(std::vector<CellChange> &out)
+    {
+        out.clear();
+        out.reserve(dirtyCells.size());
+        for (int idx : dirtyCells)
+        {
+            cellFlags[idx] &= ~CELL_DIRTY;
+            CellChange change;
+            getCoords(idx, change.x, change.y, change.z);
+            change.tileId = grid[idx].collapsedTile;
+            out.push_back(change);
+        }
+        dirtyCells.clear();
     }
 
-    // Une seule étape de l'algo
-    bool step()
+    int getPendingChangeCount() const { return (int)dirtyCells.size(); }
+    int getCollapsedCount() const { return collapsedCount; }
+
+    // Collapse parallèle : jusqu'à maxCells cellules de faible entropie, distantes d'au moins
+    // 2 * rayon + 2 (Chebyshev), ont leur vague calculée en même temps sur le pool. Les vagues
+    // restées dans leur cube sont indépendantes et appliquées telles quelles, sans repropager ;
+    // les autres (vague trop étendue, contradiction) sont rejouées en série. Le résultat ne
+    // dépend pas du nombre de threads, à maxCells égal : la taille du lot par défaut est donc fixe,
+    // pas déduite de la taille du pool.
+    bool stepBatch(ThreadPool &pool, int maxCells = 64)
     {
         if (failed)
             return false;
+        if (!entropyTracked)
+            refreshEntropy();
+        if (entropyHeap.empty())
+            return false; // Tout est fini
 
-        // Entropie Min
-        int minEntropy = INT_MAX;
-        std::vector<std::tuple<int, int, int>> candidates;
+        maxCells = std::max(maxCells, 1);
+        int minDistance = 2 * speculationRadius + 2;
 
-        for (int x = 0; x < width; x++)
+        // Les plus basses entropies d'abord, en écartant les cellules trop proches d'une autre
+        std::vector<SpeculativeWave> batch;
+        std::vector<StoredCoord> picked;
+        entropyHeap.visitInOrder(maxCells * 4, [&](int idx)
         {
-            for (int z = 0; z < depth; z++)
+            int x, y, z;
+            getCoords(idx, x, y, z);
+            for (const StoredCoord &other : picked)
             {
-                for (int y = 0; y < height; y++)
-                {
-                    Cell &c = grid[getIndex(x, y, z)];
-                    if (!c.isCollapsed())
-                    {
-                        int ent = c.entropy();
+                if (std::abs(x - other.x) < minDistance && std::abs(y - other.y) < minDistance &&
+                    std::abs(z - other.z) < minDistance)
+                    return true;
+            }
+            picked.push_back({(uint16_t)x, (uint16_t)y, (uint16_t)z});
+            batch.push_back({idx, -1, false, {}});
+            return (int)batch.size() < maxCells;
+        });
 
-                        // Désactivé pour le moment : meilleure performances sans changement de résultat
-                        // Utile si on change les règles de génération
-                        // Si une cellule n'a plus aucune option, c'est un échec
-                        /*if (ent == 0)
-                        {
-                            /*
-                            failed = true;
-                            std::cout << "Echec WFC : Contradiction trouvee en " << x << "," << y << "," << z << std::endl;
-                            return false;*
-                            candidates.clear();
-                            candidates.push_back({x, y, z});
-                            goto ForceCollapse;
-                        }*/
-
-                        if (ent < minEntropy)
-                        {
-                            minEntropy = ent;
-                            candidates.clear();
-                            candidates.push_back({x, y, z});
-                            break;
-                        }
-                        else if (ent == minEntropy)
-                        {
-                            candidates.push_back({x, y, z});
-                            break;
-                        }
-                    }
-                }
+        // Tirages en série (le cache des tables d'alias n'est pas partagé entre threads)
+        for (SpeculativeWave &wave : batch)
+        {
+            int x, y, z;
+            getCoords(wave.idx, x, y, z);
+            float u = rng.unit(cellKey(wave.idx), attempts[wave.idx]++, RNG_COLLAPSE);
+            wave.tileId = pickTile(x, y, z, grid[wave.idx].possibleTiles, u);
+        }
+
+        pool.parallelFor((int)batch.size(), [&](int i) { speculate(batch[i]); });
+
+        for (const SpeculativeWave &wave : batch)
+        {
+            if (!wave.ok)
+                continue;
+            pushDecision(wave.idx, wave.tileId);
+            commitTile(wave.idx, wave.tileId);
+            for (const auto &change : wave.changes)
+                removeTiles(change.first, grid[change.first].possibleTiles.without(change.second));
+            discardPending(); // Déjà propagé par la vague (et compteurs AC-4 mis à jour au passage)
+            speculativeCommits++;
+        }
+
+        for (const SpeculativeWave &wave : batch)
+        {
+            if (wave.ok || grid[wave.idx].isCollapsed())
+                continue;
+            speculativeConflicts++;
+            if (failed)
+                return false;
+
+            // La tuile tirée reste valable si une vague rejouée avant ne l'a pas retirée
+            int tileId = wave.tileId;
+            if (!grid[wave.idx].possibleTiles.test(tileId))
+            {
+                int x, y, z;
+                getCoords(wave.idx, x, y, z);
+                float u = rng.unit(cellKey(wave.idx), attempts[wave.idx]++, RNG_COLLAPSE);
+                tileId = pickTile(x, y, z, grid[wave.idx].possibleTiles, u);
             }
+            if (!collapseSerial(wave.idx, tileId))
+                return false;
         }
+        return !failed;
+    }
 
-        if (candidates.empty())
-            return false; // Tout est fini
+    // Réparation locale des contradictions que le retour arrière n'a pas pu résoudre : cube de
+    // rayon `radius` (doublé si la réparation échoue), au plus maxRepairTotal fois (0 désactive)
+    void setLocalRepair(int radius, int maxRepairTotal)
+    {
+        repairRadius = radius;
+        maxRepairs = maxRepairTotal;
+    }
 
-        ForceCollapse:
-        // 2. Collapse
-        std::uniform_int_distribution<> distIdx(0, (int)candidates.size() - 1);
-        auto [tx, ty, tz] = candidates[distIdx(rng)];
-        Cell &target = grid[getIndex(tx, ty, tz)];
+    int getRepairCount() const { return repairCount; }
 
-        // Sécurité
-        if (target.possibleTiles.empty())
+    // Rayon du cube d'écriture d'une vague spéculative (voir stepBatch)
+    void setSpeculationRadius(int radius) { speculationRadius = std::max(radius, 1); }
+    long long getSpeculativeCommits() const { return speculativeCommits; }
+    long long getSpeculativeConflicts() const { return speculativeConflicts; }
+
+    // Point de sauvegarde binaire (format : voir EngineState.h). L'historique du retour arrière
+    // n'est pas conservé ; la politique de poids reste celle du moteur qui recharge.
+    std::vector<uint8_t> saveState() const
+    {
+        WFCStateHeader header = {};
+        std::memcpy(header.magic, "WFCS", 4);
+        header.version = WFC_STATE_VERSION;
+        header.width = width;
+        header.height = height;
+        header.depth = depth;
+        header.tileCount = tileCount;
+        header.maskWords = (int32_t)(sizeof(DomainMask) / sizeof(uint64_t));
+        header.layout = (int32_t)layout;
+        header.gridSize = (int32_t)grid.size();
+        header.propagationMode = (int32_t)propagationMode;
+        header.entropyMode = (int32_t)entropyMode;
+        header.scanOrder = (int32_t)scanOrder;
+        header.scanCursor = scanCursor;
+        header.originX = originX;
+        header.originY = originY;
+        header.originZ = originZ;
+        header.conflictIdx = conflictIdx;
+        header.collapsedCount = collapsedCount;
+        header.backtrackCount = backtrackCount;
+        header.repairCount = repairCount;
+        header.pendingCount = workQueue.size();
+        header.failed = failed;
+        header.entropyTracked = entropyTracked;
+        header.rulesHash = rulesHash();
+        header.seed = rng.seed;
+        header.waveCount = waveCount;
+        header.processedCount = processedCount;
+
+        size_t cells = grid.size();
+        std::vector<DomainMask> domains(cells);
+        std::vector<int16_t> collapsed(cells);
+        for (size_t idx = 0; idx < cells; idx++)
+        {
+            domains[idx] = grid[idx].possibleTiles;
+            collapsed[idx] = (int16_t)grid[idx].collapsedTile;
+        }
+        std::vector<int32_t> pendingCells(header.pendingCount);
+        std::vector<DomainMask> pendingMasks(header.pendingCount);
+        for (int i = 0; i < header.pendingCount; i++)
         {
-            for (const auto &t : tileSet)
-                target.possibleTiles.insert(t.id);
-            //failed = true;
-            //return false;
+            pendingCells[i] = workQueue.at(i);
+            pendingMasks[i] = pendingRemoved[pendingCells[i]];
         }
 
-        std::vector<int> options(target.possibleTiles.begin(), target.possibleTiles.end());
-        std::vector<float> weights;
-        float totalWeight = 0.0f;
+        StateWriter out;
+        out.write(&header, sizeof(header));
+        out.write(domains.data(), cells * sizeof(DomainMask));
+        out.write(initialDomains.data(), cells * sizeof(DomainMask));
+        out.write(attempts.data(), cells * sizeof(uint32_t));
+        out.write(collapsed.data(), cells * sizeof(int16_t));
+        out.write(pendingCells.data(), pendingCells.size() * sizeof(int32_t));
+        out.write(pendingMasks.data(), pendingMasks.size() * sizeof(DomainMask));
+        return std::move(out.bytes);
+    }
+
+    bool saveState(const std::string &path) const
+    {
+        std::vector<uint8_t> bytes = saveState();
+        std::ofstream file(path, std::ios::binary);
+        file.write((const char *)bytes.data(), (std::streamsize)bytes.size());
+        return (bool)file;
+    }
+
+    // Recharge un état produit par saveState() sur un moteur de mêmes dimensions, disposition
+    // et règles. Le tampon peut être un fichier projeté en mémoire (voir MappedFile).
+    bool loadState(const void *data, size_t size)
+    {
+        if (configError)
+            return false;
 
-        for (int tileId : options)
+        StateReader in{(const uint8_t *)data, size};
+        const uint8_t *headerBytes = in.next(sizeof(WFCStateHeader));
+        if (!headerBytes)
+        {
+            std::cout << "Etat WFC : fichier tronque" << std::endl;
+            return false;
+        }
+        WFCStateHeader header;
+        std::memcpy(&header, headerBytes, sizeof(header));
+        if (std::memcmp(header.magic, "WFCS", 4) != 0 || header.version != WFC_STATE_VERSION)
+        {
+            std::cout << "Etat WFC : format ou version inconnus" << std::endl;
+            return false;
+        }
+        if (header.width != width || header.height != height || header.depth != depth ||
+            header.tileCount != tileCount || header.maskWords != (int32_t)(sizeof(DomainMask) / sizeof(uint64_t)) ||
+            header.layout != (int32_t)layout || header.gridSize != (int32_t)grid.size() ||
+            header.rulesHash != rulesHash())
         {
-            float w = tileSet[tileId].baseWeight;
+            std::cout << "Etat WFC : dimensions, disposition ou regles differentes" << std::endl;
+            return false;
+        }
 
-            // Si une fonction de biais est définie, on l'utilise pour modifier le poids localement
-            if (weightOverride)
-            {
-                w *= weightOverride(tileId, tx, ty, tz);
-            }
+        // Le tampon peut venir d'un fichier : tout est vérifié avant de toucher au moteur
+        if (header.propagationMode < 0 || header.propagationMode > (int32_t)PropagationMode::SupportCount ||
+            header.entropyMode < 0 || header.entropyMode > (int32_t)EntropyMode::Shannon ||
+            header.scanOrder < 0 || header.scanOrder > (int32_t)SelectionOrder::Columns ||
+            header.scanCursor < 0 || header.scanCursor > (int32_t)storedCells.size() || header.pendingCount < 0)
+        {
+            std::cout << "Etat WFC : en-tete invalide" << std::endl;
+            return false;
+        }
 
-            weights.push_back(w);
-            totalWeight += w;
+        size_t cells = grid.size();
+        const uint8_t *domains = in.next(cells * sizeof(DomainMask));
+        const uint8_t *initial = in.next(cells * sizeof(DomainMask));
+        const uint8_t *attemptBytes = in.next(cells * sizeof(uint32_t));
+        const uint8_t *collapsed = in.next(cells * sizeof(int16_t));
+        const uint8_t *pendingCells = in.next((size_t)header.pendingCount * sizeof(int32_t));
+        const uint8_t *pendingMasks = in.next((size_t)header.pendingCount * sizeof(DomainMask));
+        if (!domains || !initial || !attemptBytes || !collapsed || !pendingCells || !pendingMasks)
+        {
+            std::cout << "Etat WFC : fichier tronque" << std::endl;
+            return false;
         }
 
-        std::uniform_real_distribution<float> distWeight(0.0f, totalWeight);
-        float randomValue = distWeight(rng);
-        int pickedTile = options.back();
+        auto readMask = [](const uint8_t *section, size_t i)
+        {
+            DomainMask mask;
+            std::memcpy(&mask, section + i * sizeof(DomainMask), sizeof(DomainMask));
+            return mask;
+        };
+        auto readTile = [&](size_t idx)
+        {
+            int16_t tile;
+            std::memcpy(&tile, collapsed + idx * sizeof(int16_t), sizeof(tile));
+            return (int)tile;
+        };
+        DomainMask allTiles;
+        allTiles.fill(tileCount);
+        std::vector<char> stored(cells, 0); // Les briques partielles laissent des cases hors grille
+        for (int idx : storedCells)
+            stored[idx] = 1;
+        auto validCell = [&](int32_t idx) { return idx >= 0 && idx < (int32_t)cells && stored[idx]; };
 
-        float currentSum = 0.0f;
-        for (size_t i = 0; i < options.size(); i++)
+        for (size_t idx = 0; idx < cells; idx++)
+        {
+            DomainMask domain = readMask(domains, idx);
+            int tile = readTile(idx);
+            if (!domain.without(allTiles).empty() || !readMask(initial, idx).without(allTiles).empty() ||
+                tile < -1 || tile >= tileCount || (tile >= 0 && !domain.test(tile)))
+            {
+                std::cout << "Etat WFC : cellule " << idx << " invalide" << std::endl;
+                return false;
+            }
+        }
+        for (int i = 0; i < header.pendingCount; i++)
         {
-            currentSum += weights[i];
-            if (randomValue <= currentSum)
+            int32_t idx;
+            std::memcpy(&idx, pendingCells + i * sizeof(int32_t), sizeof(idx));
+            if (!validCell(idx) || !readMask(pendingMasks, i).without(allTiles).empty())
             {
-                pickedTile = options[i];
-                break;
+                std::cout << "Etat WFC : file de propagation invalide" << std::endl;
+                return false;
             }
         }
+        if (header.conflictIdx != -1 && !validCell(header.conflictIdx))
+        {
+            std::cout << "Etat WFC : en-tete invalide" << std::endl;
+            return false;
+        }
+
+        for (size_t idx = 0; idx < cells; idx++)
+        {
+            grid[idx].possibleTiles = readMask(domains, idx);
+            grid[idx].collapsedTile = readTile(idx);
+        }
+        std::memcpy(initialDomains.data(), initial, cells * sizeof(DomainMask));
+        std::memcpy(attempts.data(), attemptBytes, cells * sizeof(uint32_t));
+        collapsedCount = 0; // Recompté plutôt que lu
+        for (int idx : storedCells)
+            collapsedCount += grid[idx].isCollapsed();
+
+        // File de propagation dans son ordre d'origine
+        while (!workQueue.empty())
+            dequeue();
+        for (auto &pending : pendingRemoved)
+            pending.clear();
+        for (int i = 0; i < header.pendingCount; i++)
+        {
+            int32_t idx;
+            std::memcpy(&idx, pendingCells + i * sizeof(int32_t), sizeof(idx));
+            pendingRemoved[idx] = readMask(pendingMasks, i);
+            enqueue(idx);
+        }
 
-        target.possibleTiles.clear();
-        target.possibleTiles.insert(pickedTile);
-        target.collapsedTile = pickedTile;
+        rng.seed = header.seed;
+        originX = header.originX;
+        originY = header.originY;
+        originZ = header.originZ;
+        failed = header.failed != 0;
+        conflictIdx = header.conflictIdx;
+        backtrackCount = header.backtrackCount;
+        repairCount = header.repairCount;
+        waveCount = header.waveCount;
+        processedCount = header.processedCount;
+        scanOrder = (SelectionOrder)header.scanOrder;
+        scanCursor = header.scanCursor;
+        entropyMode = (EntropyMode)header.entropyMode;
+        propagationMode = (PropagationMode)header.propagationMode;
+        clearTrail();
 
-        // 3. Propagate
-        propagate(tx, ty, tz);
+        // Compteurs AC-4 : les tuiles en attente comptent encore chez les voisins
+        if (propagationMode == PropagationMode::SupportCount)
+        {
+            for (int i = 0; i < workQueue.size(); i++)
+                grid[workQueue.at(i)].possibleTiles |= pendingRemoved[workQueue.at(i)];
+            rebuildSupports();
+            for (int i = 0; i < workQueue.size(); i++)
+                grid[workQueue.at(i)].possibleTiles = grid[workQueue.at(i)].possibleTiles.without(pendingRemoved[workQueue.at(i)]);
+        }
+        else
+            std::vector<uint16_t>().swap(supports);
 
+        for (int idx : storedCells)
+        {
+            tieBreak[idx] = rng.unit(cellKey(idx), 0, RNG_TIE_BREAK);
+            markDirty(idx); // Les consommateurs doivent tout relire
+        }
+        if (header.entropyTracked)
+            refreshEntropy();
+        else
+        {
+            entropyTracked = false; // Reconstruit au retour à MinEntropy
+            entropyHeap.clear();
+        }
         return true;
     }
 
+    bool loadState(const std::string &path)
+    {
+        MappedFile file(path);
+        return loadState(file.data(), file.size());
+    }
+
     // Accesseurs
     const Cell &getCell(int x, int y, int z) const { return grid[getIndex(x, y, z)]; }
+
+    // Ordre des tableaux par cellule passés à reset(perCell) : x, puis z, puis y
+    int linearIndex(int x, int y, int z) const { return y * (width * depth) + z * width + x; }
+    int getCellCount() const { return width * height * depth; }
+    GridLayout getLayout() const { return layout; }
     const TileRule &getTile(int id) const { return tileSet[id]; }
+    float getEntropy(int x, int y, int z) const { return cellEntropy(getIndex(x, y, z)); }
+    EntropyMode getEntropyMode() const { return entropyMode; }
+    PropagationMode getPropagationMode() const { return propagationMode; }
+    const AdjacencyTable &getAdjacency() const { return adjacency; }
     int getWidth() const { return width; }
     int getHeight() const { return height; }
     int getDepth() const { return depth; }
     bool isFailed() const { return failed; }
-};
\ No newline at end of file
+    int getBacktrackCount() const { return backtrackCount; }
+
+    PropagationStats getPropagationStats() const
+    {
+        PropagationStats stats;
+        stats.waves = waveCount;
+        stats.cellsProcessed = processedCount;
+        stats.maxQueueDepth = workQueue.getMaxDepth();
+        stats.queueCapacity = workQueue.capacity();
+        stats.queueGrowths = workQueue.getGrowths();
+        return stats;
+    }
+};
+
+using WFCEngine = BasicWFCEngine<FunctionWeights>;
\ No newline at end of file
@@ -0,0 +1,153 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <cstdint>
+#include "DomainMask.h"
+
+// Politiques de poids pour BasicWFCEngine<WeightPolicy>.
+// Une politique est un objet appelable float(int tileId, int x, int y, int z) : le moteur
+// multiplie ce facteur au baseWeight de la tuile. Connue à la compilation, elle est inlinée
+// dans le tirage pondéré.
+//
+// Forme groupée optionnelle : void fill(int x, int y, int z, const DomainMask &domain, float *out) const
+// écrit out[tileId] pour toutes les tuiles du domaine en un seul appel, ce qui permet de ne lire
+// qu'une fois les données de la cellule. Le moteur l'utilise dès qu'elle existe.
+
+using WeightFunc = std::function<float(int tileId, int x, int y, int z)>;
+
+template <typename Policy, typename = void>
+struct HasBatchWeights : std::false_type
+{
+};
+
+template <typename Policy>
+struct HasBatchWeights<Policy, std::void_t<decltype(std::declval<const Policy &>().fill(
+                                   0, 0, 0, std::declval<const DomainMask &>(), (float *)nullptr))>> : std::true_type
+{
+};
+
+// Catégorie optionnelle : int category(int x, int y, int z) const. Deux cellules de même catégorie
+// ont les mêmes poids, le moteur peut alors partager ses tables de tirage (voir AliasTable.h).
+template <typename Policy, typename = void>
+struct HasWeightCategory : std::false_type
+{
+};
+
+template <typename Policy>
+struct HasWeightCategory<Policy, std::void_t<decltype((int)std::declval<const Policy &>().category(0, 0, 0))>>
+    : std::true_type
+{
+};
+
+// Remplit out[tileId] pour les tuiles de `domain`, via fill() si la politique le fournit
+template <typename Policy>
+void fillPolicyWeights(const Policy &policy, int x, int y, int z, const DomainMask &domain, float *out)
+{
+    if constexpr (HasBatchWeights<Policy>::value)
+        policy.fill(x, y, z, domain, out);
+    else
+        domain.forEach([&](int tileId) { out[tileId] = policy(tileId, x, y, z); });
+}
+
+// Fonction quelconque fournie à l'exécution (appel indirect), 1.0 si aucune
+struct FunctionWeights
+{
+    WeightFunc func;
+
+    FunctionWeights() = default;
+    FunctionWeights(WeightFunc f) : func(std::move(f)) {}
+
+    float operator()(int tileId, int x, int y, int z) const
+    {
+        return func ? func(tileId, x, y, z) : 1.0f;
+    }
+};
+
+// Table plate précalculée : une ligne de tileCount poids par cellule,
+// cellules dans l'ordre linéaire du moteur (x, puis z, puis y)
+struct TableWeights
+{
+    int width = 0, height = 0, depth = 0, tileCount = 0;
+    std::vector<float> values;
+
+    TableWeights() = default;
+    TableWeights(int w, int h, int d, int tiles)
+        : width(w), height(h), depth(d), tileCount(tiles), values((size_t)w * h * d * tiles, 1.0f) {}
+
+    float *row(int x, int y, int z) { return &values[((size_t)y * (width * depth) + z * width + x) * tileCount]; }
+    const float *row(int x, int y, int z) const { return &values[((size_t)y * (width * depth) + z * width + x) * tileCount]; }
+
+    float operator()(int tileId, int x, int y, int z) const { return row(x, y, z)[tileId]; }
+
+    void fill(int x, int y, int z, const DomainMask &domain, float *out) const
+    {
+        const float *r = row(x, y, z);
+        domain.forEach([&](int tileId) { out[tileId] = r[tileId]; });
+    }
+
+    // Précalcule d'un coup les couches [y0, y1[ depuis une autre politique (forme groupée si dispo)
+    template <typename Policy>
+    void fillSlab(const Policy &source, int y0, int y1)
+    {
+        DomainMask allTiles;
+        allTiles.fill(tileCount);
+        for (int y = y0; y < y1; y++)
+            for (int z = 0; z < depth; z++)
+                for (int x = 0; x < width; x++)
+                    fillPolicyWeights(source, x, y, z, allTiles, row(x, y, z));
+    }
+};
+
+// Poids par catégorie : chaque cellule est classée une fois (uint8_t), le poids d'une
+// tuile est ensuite une simple lecture table[catégorie][tuile], sans branchement
+struct CategoryWeights
+{
+    int width = 0, height = 0, depth = 0, tileCount = 0, categoryCount = 0;
+    std::vector<uint8_t> categories; // Ordre linéaire du moteur (x, puis z, puis y)
+    std::vector<float> table;        // [catégorie * tileCount + tuile]
+
+    CategoryWeights() = default;
+    CategoryWeights(int w, int h, int d, int tiles, int numCategories)
+        : width(w), height(h), depth(d), tileCount(tiles), categoryCount(numCategories),
+          categories((size_t)w * h * d, 0), table((size_t)numCategories * tiles, 1.0f) {}
+
+    uint8_t &category(int x, int y, int z) { return categories[(size_t)y * (width * depth) + z * width + x]; }
+    uint8_t category(int x, int y, int z) const { return categories[(size_t)y * (width * depth) + z * width + x]; }
+
+    float &weight(int categoryId, int tileId) { return table[categoryId * tileCount + tileId]; }
+    const float *categoryRow(int categoryId) const { return &table[categoryId * tileCount]; }
+
+    float operator()(int tileId, int x, int y, int z) const { return categoryRow(category(x, y, z))[tileId]; }
+
+    void fill(int x, int y, int z, const DomainMask &domain, float *out) const
+    {
+        const float *r = categoryRow(category(x, y, z));
+        domain.forEach([&](int tileId) { out[tileId] = r[tileId]; });
+    }
+};
+// Référence vers une politique partagée par plusieurs moteurs (solveurs par régions) : évite
+// de copier ses tables dans chaque moteur. Transmet fill() et category() quand elles existent.
+template <typename Policy>
+struct SharedWeights
+{
+    const Policy *policy = nullptr;
+
+    SharedWeights() = default;
+    explicit SharedWeights(const Policy &p) : policy(&p) {}
+
+    float operator()(int tileId, int x, int y, int z) const { return (*policy)(tileId, x, y, z); }
+
+    template <typename P = Policy, typename = std::enable_if_t<HasBatchWeights<P>::value>>
+    void fill(int x, int y, int z, const DomainMask &domain, float *out) const
+    {
+        policy->fill(x, y, z, domain, out);
+    }
+
+    template <typename P = Policy, typename = std::enable_if_t<HasWeightCategory<P>::value>>
+    int category(int x, int y, int z) const
+    {
+        return (int)policy->category(x, y, z);
+    }
+};
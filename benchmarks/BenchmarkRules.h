@@ -0,0 +1,19 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include "WFCEngine.h"
+
+// Tuiles "altitude" : deux voisins diffèrent d'au plus 1 niveau, dans les 6 directions.
+// Toujours soluble, et chaque choix se propage loin : bon test du voisinage à 6 cellules.
+inline std::vector<TileRule> createLevelRules(int levels)
+{
+    std::vector<TileRule> rules(levels);
+    for (int i = 0; i < levels; i++)
+    {
+        rules[i].id = i;
+        for (int dir = 0; dir < 6; dir++)
+            for (int j = std::max(0, i - 1); j <= std::min(levels - 1, i + 1); j++)
+                rules[i].validNeighbors[dir].push_back(j);
+    }
+    return rules;
+}
@@ -0,0 +1,87 @@
+// Compare les dispositions mémoire de la grille WFC (Linear, Brick4, Brick8, Morton)
+// Usage : LayoutBenchmark [taille...]   (par défaut 64 128 256)
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+#include "WFCEngine.h"
+#include "BenchmarkRules.h"
+
+static double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static const char *layoutName(GridLayout layout)
+{
+    switch (layout)
+    {
+    case GridLayout::Linear:
+        return "Linear";
+    case GridLayout::Brick4:
+        return "Brick4";
+    case GridLayout::Brick8:
+        return "Brick8";
+    default:
+        return "Morton";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; i++)
+        sizes.push_back(std::atoi(argv[i]));
+    if (sizes.empty())
+        sizes = {64, 128, 256};
+
+    const int levels = 8;
+    std::vector<TileRule> rules = createLevelRules(levels);
+    const GridLayout layouts[] = {GridLayout::Linear, GridLayout::Brick4, GridLayout::Brick8, GridLayout::Morton};
+
+    std::cout << std::setw(6) << "taille" << std::setw(8) << "layout" << std::setw(14) << "AC init (ms)"
+              << std::setw(14) << "solve (ms)" << std::setw(12) << "ns/cellule" << std::endl;
+
+    for (int n : sizes)
+    {
+        // Domaines de départ : quelques cellules imposées sur une surface ondulée,
+        // puis une passe d'arc-consistance globale
+        std::vector<DomainMask> initial(n * n * n);
+        for (int y = 0; y < n; y++)
+            for (int z = 0; z < n; z++)
+                for (int x = 0; x < n; x++)
+                {
+                    DomainMask &domain = initial[(y * n + z) * n + x];
+                    if (x % 16 == 0 && y % 16 == 0 && z % 16 == 0)
+                    {
+                        double wave = std::sin(x * 0.05) + std::cos(z * 0.07) + std::sin(y * 0.03);
+                        domain.set((int)((wave + 3.0) / 6.0 * (levels - 1) + 0.5));
+                    }
+                    else
+                        domain.fill(levels);
+                }
+
+        for (GridLayout layout : layouts)
+        {
+            WFCEngine wfc(n, n, n, rules, 1234, FunctionWeights(), layout);
+
+            auto start = std::chrono::steady_clock::now();
+            wfc.reset(initial.data());
+            double initMs = elapsedMs(start);
+
+            start = std::chrono::steady_clock::now();
+            while (wfc.step())
+                ;
+            double solveMs = elapsedMs(start);
+
+            std::cout << std::setw(6) << n << std::setw(8) << layoutName(layout) << std::fixed << std::setprecision(1)
+                      << std::setw(14) << initMs << std::setw(14) << solveMs << std::setw(12)
+                      << solveMs * 1e6 / ((double)n * n * n) << (wfc.isFailed() ? "  ECHEC" : "") << std::endl;
+        }
+    }
+    return 0;
+}
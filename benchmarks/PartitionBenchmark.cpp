@@ -0,0 +1,78 @@
+// Débit du solveur par régions (PartitionedSolver) selon le nombre de threads
+// Usage : PartitionBenchmark [largeur hauteur profondeur [taille de bloc]]   (par défaut 512 64 512 64)
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <cstdlib>
+
+#include "PartitionedSolver.h"
+#include "BenchmarkRules.h"
+
+// Paires de voisins qui violent les règles (ou cellules non résolues)
+template <typename Solver>
+static long long countViolations(const Solver &solver)
+{
+    long long violations = 0;
+    for (int y = 0; y < solver.getHeight(); y++)
+        for (int z = 0; z < solver.getDepth(); z++)
+            for (int x = 0; x < solver.getWidth(); x++)
+            {
+                int t = solver.getTile(x, y, z);
+                if (t < 0)
+                {
+                    violations++;
+                    continue;
+                }
+                if (x + 1 < solver.getWidth() && std::abs(t - solver.getTile(x + 1, y, z)) > 1)
+                    violations++;
+                if (y + 1 < solver.getHeight() && std::abs(t - solver.getTile(x, y + 1, z)) > 1)
+                    violations++;
+                if (z + 1 < solver.getDepth() && std::abs(t - solver.getTile(x, y, z + 1)) > 1)
+                    violations++;
+            }
+    return violations;
+}
+
+int main(int argc, char **argv)
+{
+    int width = 512, height = 64, depth = 512, blockSize = 64;
+    if (argc >= 4)
+    {
+        width = std::atoi(argv[1]);
+        height = std::atoi(argv[2]);
+        depth = std::atoi(argv[3]);
+    }
+    if (argc >= 5)
+        blockSize = std::atoi(argv[4]);
+
+    std::vector<TileRule> rules = createLevelRules(8);
+    FunctionWeights weights;
+
+    int maxThreads = (int)std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> threadCounts;
+    for (int t = 1; t < maxThreads; t *= 2)
+        threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    std::cout << width << "x" << height << "x" << depth << ", blocs de " << blockSize << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "blocs (ms)" << std::setw(16) << "coutures (ms)"
+              << std::setw(14) << "Mcellules/s" << std::setw(12) << "violations" << std::endl;
+
+    for (int threads : threadCounts)
+    {
+        ThreadPool pool(threads);
+        PartitionedSolver<FunctionWeights> solver(width, height, depth, rules, 1234, weights);
+        solver.setPartition(blockSize, blockSize, 4);
+        solver.solve(pool);
+
+        const PartitionStats &stats = solver.getStats();
+        double totalUs = (double)(stats.interiorTime + stats.seamTime).count();
+        std::cout << std::setw(8) << threads << std::fixed << std::setprecision(1) << std::setw(14)
+                  << stats.interiorTime.count() / 1000.0 << std::setw(16) << stats.seamTime.count() / 1000.0
+                  << std::setw(14) << (double)width * height * depth / totalUs << std::setw(12)
+                  << countViolations(solver) << std::endl;
+    }
+    return 0;
+}
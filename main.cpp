@@ -10,6 +10,7 @@
 
 #include "PerlinNoise.h"
 #include "WFCEngine.h"
+#include "BackgroundSolver.h"
 #include "RuleExtractor.h"
 #include "VegetationSystem.h"
 
@@ -415,6 +416,105 @@ const char *fragmentShaderSource = R"(
     }
 )";
 
+// Catégories géologiques : chaque cellule est classée une fois après la simulation hydrologique,
+// le WFC lit ensuite ses poids dans table[catégorie][tuile]
+enum GeologyCategory : uint8_t
+{
+    CAT_CIEL = 0,
+    CAT_SOUS_SOL_HUMIDE_DUR,
+    CAT_SOUS_SOL_HUMIDE_TENDRE,
+    CAT_SOUS_SOL_DUR,
+    CAT_SOUS_SOL_TENDRE,
+    CAT_SURFACE_ROCHE,
+    CAT_SURFACE_HUMIDE,
+    CAT_SURFACE_TEMPEREE,
+    CAT_SURFACE_SECHE,
+    CAT_COUNT
+};
+
+uint8_t classifyCell(int x, int y, int z)
+{
+    const VoxelData &data = worldData[x][y][z];
+
+    // Ciel
+    if (y > data.surfaceLevel)
+        return CAT_CIEL;
+
+    // Sous-sol
+    if (y < data.surfaceLevel)
+    {
+        bool wet = data.waterAmount > 0.8f;
+        if (data.hardness > 0.6f)
+            return wet ? CAT_SOUS_SOL_HUMIDE_DUR : CAT_SOUS_SOL_DUR;
+        else
+            return wet ? CAT_SOUS_SOL_HUMIDE_TENDRE : CAT_SOUS_SOL_TENDRE;
+    }
+
+    // Surface (dépend de l'humidité calculée par la simulation passe 2)
+    if (data.hardness > 0.7f)
+        return CAT_SURFACE_ROCHE;
+    if (data.humidity > 0.6f)
+        return CAT_SURFACE_HUMIDE; // Zone Humide -> Forêt
+    if (data.humidity > 0.3f)
+        return CAT_SURFACE_TEMPEREE; // Zone Tempérée -> Herbe
+    return CAT_SURFACE_SECHE;        // Zone Sèche -> Sable
+}
+
+CategoryWeights createGeologyWeights(int tileCount)
+{
+    CategoryWeights weights(GRID_SIZE, GRID_HEIGHT, GRID_SIZE, tileCount, CAT_COUNT);
+
+    // 1--- Classement des cellules
+    for (int x = 0; x < GRID_SIZE; x++)
+        for (int y = 0; y < GRID_HEIGHT; y++)
+            for (int z = 0; z < GRID_SIZE; z++)
+                weights.category(x, y, z) = classifyCell(x, y, z);
+
+    // 2--- Biais de génération par catégorie
+    const float EPSILON = 0.0001f;
+    for (int c = 0; c < CAT_COUNT; c++)
+        for (int id = 0; id < tileCount; id++)
+            weights.weight(c, id) = EPSILON;
+
+    // Ciel
+    weights.weight(CAT_CIEL, AIR) = 100.0f;
+
+    // Sous-sol : ni air ni surface
+    for (int c : {CAT_SOUS_SOL_HUMIDE_DUR, CAT_SOUS_SOL_HUMIDE_TENDRE, CAT_SOUS_SOL_DUR, CAT_SOUS_SOL_TENDRE})
+    {
+        for (int id : {AIR, SURFACE_FORET, SURFACE_HERBE, SURFACE_SABLE, SURFACE_ROCHE})
+            weights.weight(c, id) = 0.0f;
+        for (int id : {DEEP_CALCAIRE, DEEP_GRANITE, DEEP_EAU})
+            weights.weight(c, id) = 0.5f;
+    }
+    weights.weight(CAT_SOUS_SOL_HUMIDE_DUR, DEEP_EAU) = 20.0f;
+    weights.weight(CAT_SOUS_SOL_HUMIDE_TENDRE, DEEP_EAU) = 20.0f;
+    weights.weight(CAT_SOUS_SOL_HUMIDE_DUR, DEEP_GRANITE) = 10.0f;
+    weights.weight(CAT_SOUS_SOL_DUR, DEEP_GRANITE) = 10.0f;
+    weights.weight(CAT_SOUS_SOL_HUMIDE_TENDRE, DEEP_CALCAIRE) = 10.0f;
+    weights.weight(CAT_SOUS_SOL_TENDRE, DEEP_CALCAIRE) = 10.0f;
+
+    // Surface : jamais d'air
+    for (int c : {CAT_SURFACE_ROCHE, CAT_SURFACE_HUMIDE, CAT_SURFACE_TEMPEREE, CAT_SURFACE_SECHE})
+        weights.weight(c, AIR) = 0.0f;
+
+    weights.weight(CAT_SURFACE_ROCHE, SURFACE_ROCHE) = 10.0f;
+
+    weights.weight(CAT_SURFACE_HUMIDE, SURFACE_FORET) = 20.0f;
+    weights.weight(CAT_SURFACE_HUMIDE, SURFACE_HERBE) = 5.0f;
+
+    weights.weight(CAT_SURFACE_TEMPEREE, SURFACE_HERBE) = 20.0f;
+    weights.weight(CAT_SURFACE_TEMPEREE, SURFACE_FORET) = 2.0f;
+    weights.weight(CAT_SURFACE_TEMPEREE, SURFACE_SABLE) = 2.0f;
+
+    weights.weight(CAT_SURFACE_SECHE, SURFACE_SABLE) = 20.0f;
+    weights.weight(CAT_SURFACE_SECHE, SURFACE_HERBE) = 1.0f;
+
+    return weights;
+}
+
+using GeologyWFC = BasicWFCEngine<CategoryWeights>;
+
 std::vector<PlantInstance> worldPlants;
 
 float randomFloat()
@@ -422,7 +522,8 @@ float randomFloat()
     return (float)rand() / (float)RAND_MAX;
 }
 
-void generateVegetation(WFCEngine &wfc)
+// snapshot : dernier instantané publié par le solveur (voir BackgroundSolver.h)
+void generateVegetation(const GeologyWFC &wfc, const TileSnapshot &snapshot)
 {
     std::cout << "Passe 4 : Generation Vegetation..." << std::endl;
     worldPlants.clear();
@@ -436,11 +537,12 @@ void generateVegetation(WFCEngine &wfc)
             int surfaceY = worldData[x][0][z].surfaceLevel;
 
             // On récupère le bloc WFC à la surface
-            const Cell &c = wfc.getCell(x, surfaceY, z);
-            if (!c.isCollapsed())
+            if (snapshot.tiles.empty())
+                continue;
+            int tileId = snapshot.tiles[wfc.linearIndex(x, surfaceY, z)];
+            if (tileId < 0)
                 continue;
 
-            int tileId = c.collapsedTile;
             float humidity = worldData[x][surfaceY][z].humidity;
 
             PlantType plantToPlace = PLANT_NONE;
@@ -645,66 +747,45 @@ int main()
     auto rules = createGeologyRules();
 
     std::cout << "Passe 3 : Initialisation WFC..." << std::endl;
-    WFCEngine wfc(GRID_SIZE, GRID_HEIGHT, GRID_SIZE, rules, seed);
-
-    // Mise en place des biais de génération
-    wfc.setWeightFunction([&](int tileId, int x, int y, int z) -> float
-                          {
-        const VoxelData& data = worldData[x][y][z];
+    GeologyWFC wfc(GRID_SIZE, GRID_HEIGHT, GRID_SIZE, rules, seed, createGeologyWeights((int)rules.size()));
 
-        float EPSILON = 0.0001f;
+    // Une contradiction annule les dernières décisions au lieu de tout arrêter
+    wfc.setBacktracking(64, 1000);
+    // Au-delà, la zone de la contradiction est rouverte et résolue à nouveau
+    wfc.setLocalRepair(4, 1000);
 
-        // Ciel
-        if (y > data.surfaceLevel)
-            return (tileId == AIR) ? 100.0f : EPSILON;
-        
-        // Sous-sol
-        if (y < data.surfaceLevel) {
-            if (tileId == SURFACE_FORET || tileId == SURFACE_SABLE || tileId == SURFACE_HERBE || tileId == SURFACE_ROCHE)
-                return 0.0f;
-
-            if (tileId == AIR)
-                return 0.f;
-            if (data.waterAmount > 0.8f && tileId == DEEP_EAU) return 20.0f;
-            
-            if (data.hardness > 0.6f)
-                return (tileId == DEEP_GRANITE) ? 10.0f : 0.5f;//EPSILON;
-            else
-                return (tileId == DEEP_CALCAIRE) ? 10.0f : 0.5f;//EPSILON;
-        }
-
-        // Surface (dépend de l'humidité calculée par la simulation passe 2)
-        if (y == data.surfaceLevel) {
-            if (tileId == AIR)
-                return 0.f;
-
-            if (data.hardness > 0.7f) {
-                return (tileId == SURFACE_ROCHE) ? 10.0f : EPSILON;
-            }
+    // Domaines de départ déduits de la topographie : le ciel ne peut être que de l'air,
+    // et le sous-sol jamais une tuile de surface
+    std::vector<DomainMask> initialDomains(wfc.getCellCount());
+    for (int x = 0; x < GRID_SIZE; x++)
+    {
+        for (int y = 0; y < GRID_HEIGHT; y++)
+        {
+            for (int z = 0; z < GRID_SIZE; z++)
+            {
+                DomainMask &domain = initialDomains[wfc.linearIndex(x, y, z)];
+                int surfaceLevel = worldData[x][y][z].surfaceLevel;
 
-            float h = data.humidity;
-            if (h > 0.6f) {
-                // Zone Humide -> Forêt
-                if (tileId == SURFACE_FORET) return 20.0f;
-                if (tileId == SURFACE_HERBE) return 5.0f;
-                return EPSILON;
-            } 
-            else if (h > 0.3f) {
-                // Zone Tempérée -> Herbe
-                if (tileId == SURFACE_HERBE) return 20.0f;
-                if (tileId == SURFACE_FORET) return 2.0f;
-                if (tileId == SURFACE_SABLE) return 2.0f;
-                return EPSILON;
-            } 
-            else {
-                // Zone Sèche -> Sable
-                if (tileId == SURFACE_SABLE) return 20.0f;
-                if (tileId == SURFACE_HERBE) return 1.0f;
-                return EPSILON;
+                if (y > surfaceLevel)
+                {
+                    domain.set(AIR);
+                }
+                else
+                {
+                    domain.fill((int)rules.size());
+                    if (y < surfaceLevel)
+                    {
+                        for (int id : {SURFACE_FORET, SURFACE_HERBE, SURFACE_SABLE, SURFACE_ROCHE})
+                            domain.reset(id);
+                    }
+                }
             }
         }
-        return 1.0f;
-    });
+    }
+    wfc.reset(initialDomains.data());
+
+    // Les combinaisons de poids nul (surface sous terre, air à la surface...) sont interdites d'emblée
+    wfc.pruneZeroWeights();
 
     // Buffers OpenGL
     unsigned int cubeVAO, cubeVBO, instanceVBO;
@@ -742,9 +823,27 @@ int main()
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+    // La résolution tourne sur son propre thread ; on n'affiche que ses instantanés publiés.
+    // Règles stratifiées (air / surface / sous-sol) : balayage couche par couche, sans tas d'entropie.
+    BackgroundSolver<GeologyWFC> solver(wfc, std::chrono::milliseconds(8));
+    solver.start(SelectionOrder::Layers);
+
+    // Tuile affichée par cellule, recopiée de chaque nouvel instantané.
+    // Les voxels du terrain ne sont reconstruits que si une cellule ou un mode d'affichage a changé.
+    std::vector<int> shownTiles(wfc.getCellCount(), AIR);
+    uint64_t shownSequence = 0;
+    bool terrainDirty = true;
+
+    std::vector<float> opaqueData;
+    std::vector<float> transparentData;
+    int opaqueCount = 0;
+    int transparentCount = 0;
+
     // Boucle principale
     while (!glfwWindowShouldClose(window))
     {
+        const TileSnapshot &snapshot = solver.latest();
+
         if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
             glfwSetWindowShouldClose(window, true);
         // Toggle mode nappes (Touche W)
@@ -758,6 +857,7 @@ int main()
                 if (showWaterMode)
                     showMyceliumMode = false;
 
+                terrainDirty = true;
                 wPressed = true;
             }
         }
@@ -774,6 +874,7 @@ int main()
                 if (showMyceliumMode)
                     showWaterMode = false;
 
+                terrainDirty = true;
                 mPressed = true;
             }
         }
@@ -789,6 +890,7 @@ int main()
                 bool state = !showBlockTypes[1];
                 for (int i = 1; i <= 4; i++)
                     showBlockTypes[i] = state;
+                terrainDirty = true;
                 k1Pressed = true;
             }
         }
@@ -804,6 +906,7 @@ int main()
                 bool state = !showBlockTypes[5];
                 for (int i = 5; i <= 7; i++)
                     showBlockTypes[i] = state;
+                terrainDirty = true;
                 k2Pressed = true;
             }
         }
@@ -817,6 +920,7 @@ int main()
             if (!k3Pressed)
             {
                 showBlockTypes[DEEP_GRANITE] = !showBlockTypes[DEEP_GRANITE];
+                terrainDirty = true;
                 k3Pressed = true;
             }
         }
@@ -829,7 +933,7 @@ int main()
         {
             if (!vPressed)
             {
-                generateVegetation(wfc);
+                generateVegetation(wfc, snapshot);
                 vPressed = true;
             }
         }
@@ -837,13 +941,7 @@ int main()
             vPressed = false;
 
         // Rendu
-        if (!wfc.isFailed())
-        {
-            for (int i = 0; i < 100; i++)
-                wfc.step();
-        }
-
-        if (wfc.isFailed())
+        if (snapshot.failed)
             glClearColor(0.5f, 0.0f, 0.0f, 1.0f); // Rouge = Erreur
         else
             glClearColor(0.5f, 0.7f, 1.0f, 1.0f); // Bleu = OK
@@ -865,33 +963,39 @@ int main()
 
         int scaleLoc = glGetUniformLocation(shaderProgram, "uScale");
 
+        // Nouvel instantané : les tuiles non fixées sont affichées comme de l'air
+        if (snapshot.sequence != shownSequence)
+        {
+            for (size_t i = 0; i < snapshot.tiles.size(); i++)
+                shownTiles[i] = (snapshot.tiles[i] >= 0) ? (int)snapshot.tiles[i] : (int)AIR;
+            shownSequence = snapshot.sequence;
+            terrainDirty = true;
+        }
+
         // Construction du buffer d'affichage
-        std::vector<float> opaqueData;
         std::vector<float> largePlantData;
         std::vector<float> smallPlantData;
-        std::vector<float> transparentData;
 
-        int opaqueCount = 0;
         int largePlantCount = 0;
         int smallPlantCount = 0;
-        int transparentCount = 0;
 
-        // Remplissage des vecteurs de données du terrain
-        for (int x = 0; x < GRID_SIZE; x++)
+        // Remplissage des vecteurs de données du terrain (conservés tant que rien n'a changé)
+        bool rebuildTerrain = terrainDirty;
+        terrainDirty = false;
+        if (rebuildTerrain)
+        {
+            opaqueData.clear();
+            transparentData.clear();
+            opaqueCount = 0;
+            transparentCount = 0;
+        }
+        for (int x = 0; rebuildTerrain && x < GRID_SIZE; x++)
         {
             for (int y = 0; y < GRID_HEIGHT; y++)
             {
                 for (int z = 0; z < GRID_SIZE; z++)
                 {
-
-                    const Cell &c = wfc.getCell(x, y, z);
-                    int tid = AIR;
-
-                    // Récupération ID (avec Fallback)
-                    if (c.isCollapsed())
-                        tid = c.collapsedTile;
-                    else if ((false)&&(y <= worldData[x][y][z].surfaceLevel))
-                        tid = DEEP_CALCAIRE;
+                    int tid = shownTiles[wfc.linearIndex(x, y, z)];
 
                     if (tid == AIR)
                         continue;